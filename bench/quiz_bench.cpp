@@ -0,0 +1,224 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "quiz_room.h"
+#include "text_layout.h"
+
+// Run from the build directory (like quiz) so ./assets resolves
+#define QUESTIONS_DIR ASSETS_BASE "/questions"
+#define BENCH_HISTORY_FILE "/tmp/quiz-bench-history"
+#define DEFAULT_OUT "quiz_bench.json"
+
+static SharedAssets & assets() {
+  static SharedAssets assets;
+  return assets;
+}
+
+static BankSnapshot const & bank() {
+  static BankSnapshot bank = load_question_bank(QUESTIONS_DIR);
+  return bank;
+}
+
+static std::vector<std::string> const & question_texts() {
+  static std::vector<std::string> texts = [] {
+    std::vector<std::string> texts;
+    for (auto const & category : bank()->categories) {
+      for (auto const & question : category->questions) {
+        texts.push_back(question.question);
+      }
+    }
+    return texts;
+  }();
+  return texts;
+}
+
+static CImg<uint8_t> plasma_canvas(int width, int height) {
+  CImg<uint8_t> canvas(width, height, 1, 3);
+  canvas.draw_plasma();
+  return canvas;
+}
+
+static void BM_RgbToYuyv(benchmark::State & state) {
+  auto canvas = plasma_canvas(state.range(0), state.range(1));
+  std::vector<uint8_t> frame_buffer(canvas.width() * canvas.height() * 2);
+  for (auto _ : state) {
+    rgb_to_yuyv(canvas, frame_buffer);
+    benchmark::DoNotOptimize(frame_buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * canvas.width() * canvas.height());
+}
+BENCHMARK(BM_RgbToYuyv)->Args({640, 480})->Args({1280, 720})->Args({1920, 1080});
+
+static void BM_RgbToI420(benchmark::State & state) {
+  auto canvas = plasma_canvas(state.range(0), state.range(1));
+  FrameFormat format { PixelFormat::I420, canvas.width(), canvas.height() };
+  std::vector<uint8_t> frame_buffer(format.size());
+  for (auto _ : state) {
+    rgb_to_i420(canvas, frame_buffer);
+    benchmark::DoNotOptimize(frame_buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * canvas.width() * canvas.height());
+}
+BENCHMARK(BM_RgbToI420)->Args({640, 480})->Args({1280, 720})->Args({1920, 1080});
+
+static void BM_TextWidth(benchmark::State & state) {
+  auto const & texts = question_texts();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text_width(texts[i++ % texts.size()], assets().font, TEXT_SIZE));
+  }
+}
+BENCHMARK(BM_TextWidth);
+
+static void BM_WrapText(benchmark::State & state) {
+  auto const & texts = question_texts();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+      wrap_text(texts[i++ % texts.size()], assets().font, TEXT_SIZE, SAFE_WIDTH));
+  }
+}
+BENCHMARK(BM_WrapText);
+
+// Arg is the stroke width
+static void BM_DrawText(benchmark::State & state) {
+  CImg<uint8_t> canvas(WIDTH, HEIGHT, 1, 3, 0);
+  std::string line = "What is the capital city of Australia?";
+  for (auto _ : state) {
+    draw_text(canvas, 10, HEIGHT / 2, line, assets().font, TEXT_SIZE,
+      QUESTION_ORANGE, -1, state.range(0), DUE_WHITE);
+    benchmark::DoNotOptimize(canvas.data());
+  }
+}
+BENCHMARK(BM_DrawText)->Arg(0)->Arg(1);
+
+// What every render used to do, against copying a cached background
+static void BM_PlasmaBackground(benchmark::State & state) {
+  CImg<uint8_t> canvas(WIDTH, HEIGHT, 1, 3);
+  for (auto _ : state) {
+    canvas.draw_plasma();
+    canvas.draw_rectangle(0, 0, WIDTH, HEIGHT, DUE_BLACK.c_arr(), 0.9);
+    benchmark::DoNotOptimize(canvas.data());
+  }
+}
+BENCHMARK(BM_PlasmaBackground);
+
+static void BM_CachedBackground(benchmark::State & state) {
+  CImg<uint8_t> canvas(WIDTH, HEIGHT, 1, 3);
+  std::mt19937 prng;
+  for (auto _ : state) {
+    canvas = assets().backgrounds.pick(prng);
+    benchmark::DoNotOptimize(canvas.data());
+  }
+}
+BENCHMARK(BM_CachedBackground);
+
+// Cold drops the question files from the page cache before each load
+static void BM_LoadCategories(benchmark::State & state) {
+  bool cold = state.range(0);
+  for (auto _ : state) {
+    if (cold) {
+      state.PauseTiming();
+      for (auto const & entry : std::filesystem::directory_iterator(QUESTIONS_DIR)) {
+        int fd = open(entry.path().c_str(), O_RDONLY);
+        if (fd != -1) {
+          posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+          close(fd);
+        }
+      }
+      state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(load_question_bank(QUESTIONS_DIR));
+  }
+}
+BENCHMARK(BM_LoadCategories)->ArgName("cold")->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond);
+
+static char const * const render_states[] = {
+  "title", "category", "question", "answers", "answer",
+  "tiebreak", "tiebreak_answer", "leaderboard"
+};
+
+static Quiz make_quiz(std::vector<std::unique_ptr<FrameSink>> sinks = {}) {
+  static LiveQuestionBank live_bank(bank());
+  static PlayHistory history(BENCH_HISTORY_FILE);
+  static TieBreak tie_break = load_tie_break(ASSETS_BASE "/Tie Break.json");
+  return Quiz(std::move(sinks), assets(), live_bank, history, tie_break);
+}
+
+// A headless quiz moved to the named page
+static Quiz & quiz_showing(std::string const & page) {
+  static Quiz quiz = make_quiz();
+
+  quiz.reset(5, 10);
+  if (page == "tiebreak" || page == "tiebreak_answer") {
+    quiz.start_tie_break();
+  } else if (page == "leaderboard") {
+    quiz.submit_answer("Bench", 0, 0, "?");
+    quiz.show_leaderboard();
+  }
+  for (int pages = 0; quiz.state().state != page && pages < 1000; pages++) {
+    quiz.next_page();
+  }
+  return quiz;
+}
+
+static void BM_Render(benchmark::State & state) {
+  std::string page = render_states[state.range(0)];
+  auto & quiz = quiz_showing(page);
+  if (quiz.state().state != page) {
+    state.SkipWithError(("Couldn't reach the " + page + " page").c_str());
+    return;
+  }
+  state.SetLabel(page);
+  for (auto _ : state) {
+    quiz.render();
+  }
+}
+BENCHMARK(BM_Render)->DenseRange(0, std::size(render_states) - 1)->Unit(benchmark::kMicrosecond);
+
+// Everything display() does short of the writes. Args are the number of null
+// sinks at the canvas size and the number at 720p, each size is converted once.
+static void BM_DisplayNullSinks(benchmark::State & state) {
+  std::vector<std::unique_ptr<FrameSink>> sinks;
+  for (int i = 0; i < state.range(0); i++) {
+    sinks.push_back(std::make_unique<NullSink>(FrameFormat { PixelFormat::YUYV, WIDTH, HEIGHT }));
+  }
+  for (int i = 0; i < state.range(1); i++) {
+    sinks.push_back(std::make_unique<NullSink>(FrameFormat { PixelFormat::YUYV, 1280, 720 }));
+  }
+  Quiz quiz = make_quiz(std::move(sinks));
+  for (auto _ : state) {
+    quiz.display();
+  }
+}
+BENCHMARK(BM_DisplayNullSinks)->Args({1, 0})->Args({3, 0})->Args({1, 1})->Unit(benchmark::kMicrosecond);
+
+// Results go to quiz_bench.json unless --benchmark_out says otherwise
+int main(int argc, char ** argv) {
+  std::vector<char *> args(argv, argv + argc);
+  bool has_out = false;
+  for (int i = 1; i < argc; i++) {
+    has_out |= std::strncmp(argv[i], "--benchmark_out=", 16) == 0;
+  }
+  std::string out = "--benchmark_out=" DEFAULT_OUT, format = "--benchmark_out_format=json";
+  if (!has_out) {
+    args.push_back(out.data());
+    args.push_back(format.data());
+  }
+  int count = args.size();
+  benchmark::Initialize(&count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  std::filesystem::remove(BENCH_HISTORY_FILE);
+}
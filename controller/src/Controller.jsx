@@ -1,14 +1,74 @@
 import React from 'react'
 
-const nextPage = () => {
-  fetch("/next").catch((error) => {
-    alert("Failed to goto next page: " + error)
+// Which quiz room this remote controls, from ?room=<id>
+const room = new URLSearchParams(window.location.search).get("room") || "0"
+const roomUrl = (path) => `/room/${room}${path}`
+
+const startTieBreak = () => {
+  fetch(roomUrl("/tiebreak")).catch((error) => {
+    alert("Failed to start tie break: " + error)
+  })
+}
+
+const setMode = (event) => {
+  fetch(roomUrl(`/mode/${event.target.value}`)).catch((error) => {
+    alert("Failed to change mode: " + error)
+  })
+}
+
+const showLeaderboard = () => {
+  fetch(roomUrl("/leaderboard")).catch((error) => {
+    alert("Failed to show leaderboard: " + error)
   })
 }
 
+const describeQuiz = ({ state, round, category, question }) => {
+  if (round < 0) {
+    return state
+  }
+  const where = question < 0 ? category : `${category}, question ${question + 1}`
+  return `Round ${round + 1} (${where}): ${state}`
+}
+
 class Controller extends React.Component {
   state = {
-    categories_to_play: 5, questions_per_category: 10
+    categories_to_play: 5, questions_per_category: 10, weights: "uniform",
+    quiz: null
+  }
+
+  componentDidMount() {
+    this.connect()
+  }
+
+  componentWillUnmount() {
+    clearTimeout(this.reconnect)
+    if (this.socket) {
+      this.socket.onclose = null
+      this.socket.close()
+    }
+  }
+
+  // The quiz sends its full state on connect, then only what changed
+  connect = () => {
+    this.socket = new WebSocket(`ws://${window.location.host}/ws`)
+    this.socket.onopen = () => this.socket.send(room)
+    this.socket.onmessage = (event) => {
+      const update = JSON.parse(event.data)
+      this.setState(({ quiz }) => ({ quiz: { ...quiz, ...update } }))
+    }
+    this.socket.onclose = () => {
+      this.setState({ quiz: null })
+      this.reconnect = setTimeout(this.connect, 1000)
+    }
+  }
+
+  // Says which page is being advanced from, so a double tap only moves once
+  nextPage = () => {
+    const { quiz } = this.state
+    const page = quiz ? `?page=${quiz.page}` : ""
+    fetch(roomUrl(`/next${page}`)).catch((error) => {
+      alert("Failed to goto next page: " + error)
+    })
   }
 
   updateCtp = (event) => {
@@ -19,9 +79,13 @@ class Controller extends React.Component {
     this.setState({questions_per_category: event.target.value});
   }
 
+  updateWeights = (event) => {
+    this.setState({weights: event.target.value});
+  }
+
   resetQuiz = (event) => {
-     const { categories_to_play, questions_per_category } = this.state
-     fetch(`/reset/${categories_to_play}/${questions_per_category}`)
+     const { categories_to_play, questions_per_category, weights } = this.state
+     fetch(roomUrl(`/reset/${categories_to_play}/${questions_per_category}?weights=${weights}`))
     .catch((error) => {
       alert("Failed to reset quiz: " + error)
     })
@@ -31,9 +95,21 @@ class Controller extends React.Component {
 
   render = () => (
     <div>
-      <h1>Ben's Skype Remote!</h1>
+      <h1>Ben's Skype Remote! (Room {room})</h1>
+      <p>{this.state.quiz ? describeQuiz(this.state.quiz) : "Connecting..."}</p>
       <div>
-        <button onClick={nextPage}>Next page</button>
+        <button onClick={this.nextPage}>Next page</button>
+        <button onClick={startTieBreak}>Tie break</button>
+        <button onClick={showLeaderboard}>Leaderboard</button>
+      </div>
+      <div>
+        <label>
+          Answers:
+          <select defaultValue="open" onChange={setMode}>
+            <option value="open">Open</option>
+            <option value="choice">Multiple choice</option>
+          </select>
+        </label>
       </div>
       <h2>New Quiz!</h2>
       <form onSubmit={this.resetQuiz}>
@@ -49,6 +125,16 @@ class Controller extends React.Component {
             value={this.state.questions_per_category} onChange={this.updateQpc} />
         </label>
         <br/>
+        <label>
+          Pick categories:
+          <select value={this.state.weights} onChange={this.updateWeights}>
+            <option value="uniform">Evenly</option>
+            <option value="size">By size</option>
+            <option value="fresh">Least recently played</option>
+            <option value="config">From category-weights.json</option>
+          </select>
+        </label>
+        <br/>
         <input type="submit" value="Reset"/>
       </form>
     </div>)
@@ -1,2 +1,4 @@
 #!/bin/bash
-bash -c "cd ./build/ && ./quiz" & bash -c "cd ./controller && npm start" && fg; fg
+# The remote is served by the quiz itself, build it first with
+# (cd ./controller && npm install && npm run build)
+cd ./build/ && ./quiz
@@ -0,0 +1,58 @@
+#ifndef ALIAS_TABLE_H_
+#define ALIAS_TABLE_H_
+
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <numeric>
+
+// Walker's alias method: O(n) to build, O(1) per weighted draw
+class AliasTable final {
+  std::vector<double> probability;
+  std::vector<uint32_t> alias;
+
+  public:
+    AliasTable() = default;
+
+    AliasTable(std::vector<double> const & weights)
+      : probability(weights.size()), alias(weights.size())
+    {
+      double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+      if (total <= 0) {
+        return;
+      }
+
+      std::vector<uint32_t> small, large;
+      std::vector<double> scaled(weights.size());
+      for (uint32_t i = 0; i < weights.size(); i++) {
+        scaled[i] = weights[i] * weights.size() / total;
+        (scaled[i] < 1 ? small : large).push_back(i);
+      }
+      while (!small.empty() && !large.empty()) {
+        uint32_t less = small.back(), more = large.back();
+        small.pop_back();
+        probability[less] = scaled[less];
+        alias[less] = more;
+        scaled[more] -= 1 - scaled[less];
+        if (scaled[more] < 1) {
+          large.pop_back();
+          small.push_back(more);
+        }
+      }
+      // Anything left over is 1 give or take rounding
+      for (uint32_t i : large) probability[i] = 1;
+      for (uint32_t i : small) probability[i] = 1;
+    }
+
+    size_t size() const { return probability.size(); }
+
+    template <typename URBG>
+    uint32_t sample(URBG & prng) const {
+      std::uniform_int_distribution<uint32_t> column(0, probability.size() - 1);
+      std::uniform_real_distribution<double> coin(0, 1);
+      uint32_t i = column(prng);
+      return coin(prng) < probability[i] ? i : alias[i];
+    }
+};
+
+#endif
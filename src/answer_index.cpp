@@ -0,0 +1,66 @@
+#include <cctype>
+#include <unordered_set>
+
+#include "answer_index.h"
+#include "question_bank.h"
+
+#define MAX_WORDS_BUCKET 4
+
+AnswerType answer_type(std::string_view answer) {
+  int words = 0, capitalised = 0, digits = 0, letters = 0;
+  bool in_word = false;
+  for (unsigned char c : answer) {
+    if (std::isspace(c)) {
+      in_word = false;
+      continue;
+    }
+    if (!in_word) {
+      words += 1;
+      capitalised += std::isupper(c) != 0;
+      in_word = true;
+    }
+    digits += std::isdigit(c) != 0;
+    letters += std::isalpha(c) != 0;
+  }
+
+  bool separators = answer.find_first_of(",.") != std::string_view::npos;
+  if (digits == 4 && letters <= 2 && words <= 2 && !separators) {
+    return AnswerType::YEAR;
+  }
+  if (digits > 0 && digits >= letters) {
+    return AnswerType::NUMBER;
+  }
+  if (words > 0 && capitalised == words) {
+    return words == 1 ? AnswerType::WORD : AnswerType::NAME;
+  }
+  return AnswerType::TEXT;
+}
+
+namespace {
+  uint32_t bucket_key(std::string_view answer) {
+    int words = 0;
+    bool in_word = false;
+    for (unsigned char c : answer) {
+      words += !in_word && !std::isspace(c);
+      in_word = !std::isspace(c);
+    }
+    return static_cast<uint32_t>(answer_type(answer)) * (MAX_WORDS_BUCKET + 1)
+      + std::min(words, MAX_WORDS_BUCKET);
+  }
+}
+
+AnswerIndex::AnswerIndex(std::vector<Question> const & questions) {
+  std::unordered_set<uint64_t> seen;
+  for (uint32_t q = 0; q < questions.size(); q++) {
+    auto const & answer = questions[q].answer;
+    keys.push_back(bucket_key(answer));
+    answers.push_back(question_hash(answer));
+    // Only the first question with each answer is a candidate
+    if (seen.insert(answers.back()).second) {
+      buckets[keys.back()].push_back(q);
+      everything.push_back(q);
+    } else {
+      buckets[keys.back()];
+    }
+  }
+}
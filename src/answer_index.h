@@ -0,0 +1,71 @@
+#ifndef ANSWER_INDEX_H_
+#define ANSWER_INDEX_H_
+
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+struct Question;
+
+enum class AnswerType : uint8_t {
+  YEAR,
+  NUMBER,
+  NAME, // A few capitalised words, usually people or places
+  WORD, // One capitalised word
+  TEXT
+};
+
+AnswerType answer_type(std::string_view answer);
+
+// A category's distinct answers bucketed by type and length, so plausible
+// multiple choice distractors can be picked in O(1)
+class AnswerIndex final {
+  std::unordered_map<uint32_t, std::vector<uint32_t>> buckets;
+  // Bucket key and answer hash for every question
+  std::vector<uint32_t> keys;
+  std::vector<uint64_t> answers;
+  std::vector<uint32_t> everything;
+
+  public:
+    AnswerIndex(std::vector<Question> const & questions);
+
+    // Up to `count` questions whose answers differ from `question`'s and
+    // each other's, preferring answers that look alike
+    template <typename URBG>
+    std::vector<uint32_t> distractors(uint32_t question, int count, URBG & prng) const {
+      std::vector<uint32_t> picked;
+      auto consider = [&](uint32_t candidate) {
+        bool same = answers[candidate] == answers[question];
+        for (uint32_t p : picked) {
+          same |= answers[p] == answers[candidate];
+        }
+        if (!same) {
+          picked.push_back(candidate);
+        }
+      };
+      auto pick_from = [&](std::vector<uint32_t> const & candidates) {
+        if (candidates.empty()) {
+          return;
+        }
+        std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+        if (candidates.size() <= 4 * count) {
+          // Small enough to try each, starting somewhere random
+          size_t start = pick(prng);
+          for (size_t i = 0; i < candidates.size() && picked.size() < count; i++) {
+            consider(candidates[(start + i) % candidates.size()]);
+          }
+          return;
+        }
+        for (int tries = 0; tries < 4 * count && picked.size() < count; tries++) {
+          consider(candidates[pick(prng)]);
+        }
+      };
+      pick_from(buckets.at(keys[question]));
+      pick_from(everything);
+      return picked;
+    }
+};
+
+#endif
@@ -0,0 +1,13 @@
+#include "colour.h"
+#include "background_cache.h"
+
+using namespace DueUtil::Images;
+
+BackgroundCache::BackgroundCache(int width, int height, int count) {
+  for (int i = 0; i < count; i++) {
+    cimg_library::CImg<uint8_t> background(width, height, 1, 3);
+    background.draw_plasma();
+    background.draw_rectangle(0, 0, width, height, DUE_BLACK.c_arr(), 0.9);
+    backgrounds.push_back(std::move(background));
+  }
+}
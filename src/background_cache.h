@@ -0,0 +1,24 @@
+#ifndef BACKGROUND_CACHE_H_
+#define BACKGROUND_CACHE_H_
+
+#include <random>
+#include <vector>
+
+#include <CImg.h>
+
+// Page backgrounds (darkened plasma) drawn once at startup. Plasma is slow to
+// draw and never modified afterwards, so every room can copy from the same few.
+class BackgroundCache final {
+  std::vector<cimg_library::CImg<uint8_t>> backgrounds;
+
+  public:
+    BackgroundCache(int width, int height, int count = 8);
+
+    template <typename URBG>
+    cimg_library::CImg<uint8_t> const & pick(URBG & prng) const {
+      std::uniform_int_distribution<size_t> background(0, backgrounds.size() - 1);
+      return backgrounds[background(prng)];
+    }
+};
+
+#endif
@@ -12,7 +12,7 @@ namespace DueUtil::Images {
 
     std::array<int, 3> rgb;
 
-    int32_t to_int();
+    int32_t to_int() const;
 
     int const * c_arr() const  { return &rgb[0]; }
     uint8_t * as_bytes(uint8_t bytes[]) const;
@@ -30,6 +30,10 @@ namespace DueUtil::Images {
   inline const Colour GRAY         {  204,  204,  204 };
   inline const Colour DUE_BLACK    {  48,   48,   48  };
   inline const Colour DUE_WHITE    {  238,  238,  238	};
+
+  inline const Colour SKYPE_BLUE      {  0,    175,  240  };
+  inline const Colour QUESTION_ORANGE {  255,  123,  0    };
+  inline const Colour ANSWER_PINK     {  255,  102,  255  };
 }
 
 #endif
@@ -0,0 +1,172 @@
+#include <array>
+#include <thread>
+#include <cctype>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dedupe.h"
+#include "answer_index.h"
+
+#define SIGNATURE_SIZE 64
+#define BAND_ROWS 4
+#define BANDS (SIGNATURE_SIZE / BAND_ROWS)
+
+using Signature = std::array<uint64_t, SIGNATURE_SIZE>;
+
+namespace {
+  uint64_t mix(uint64_t x) {
+    // splitmix64 finaliser
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27; x *= 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+  }
+
+  // Hashes of each normalised word and each pair of adjacent words
+  std::vector<uint64_t> shingles(std::string const & text) {
+    std::vector<uint64_t> words;
+    uint64_t word = 0;
+    bool in_word = false;
+    for (unsigned char c : text) {
+      if (std::isalnum(c) || c >= 0x80) {
+        word = (in_word ? word : 0xcbf29ce484222325) ^ std::tolower(c);
+        word *= 0x100000001b3;
+        in_word = true;
+      } else if (in_word) {
+        words.push_back(word);
+        in_word = false;
+      }
+    }
+    if (in_word) {
+      words.push_back(word);
+    }
+
+    std::vector<uint64_t> shingles(words);
+    for (size_t i = 1; i < words.size(); i++) {
+      shingles.push_back(mix(words[i - 1] * 31 + words[i]));
+    }
+    return shingles;
+  }
+
+  Signature min_hash(std::string const & text) {
+    Signature signature;
+    signature.fill(UINT64_MAX);
+    for (uint64_t shingle : shingles(text)) {
+      for (int i = 0; i < SIGNATURE_SIZE; i++) {
+        signature[i] = std::min(signature[i], mix(shingle + i * 0x9e3779b97f4a7c15));
+      }
+    }
+    return signature;
+  }
+
+  float similarity(Signature const & a, Signature const & b) {
+    int matching = 0;
+    for (int i = 0; i < SIGNATURE_SIZE; i++) {
+      matching += a[i] == b[i];
+    }
+    return float(matching) / SIGNATURE_SIZE;
+  }
+}
+
+std::vector<NearDuplicate> find_near_duplicates(
+  QuestionBank const & bank, float threshold
+) {
+  std::vector<QuestionRef> refs;
+  std::vector<Question const *> questions;
+  for (uint32_t c = 0; c < bank.categories.size(); c++) {
+    auto const & category = bank.categories[c]->questions;
+    for (uint32_t q = 0; q < category.size(); q++) {
+      refs.push_back({c, q});
+      questions.push_back(&category[q]);
+    }
+  }
+
+  std::vector<Signature> signatures(refs.size());
+  {
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < workers; w++) {
+      threads.emplace_back([&, w]{
+        for (size_t i = w; i < signatures.size(); i += workers) {
+          signatures[i] = min_hash(questions[i]->question);
+        }
+      });
+    }
+    for (auto & thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Questions with the same answer sharing any whole band of their signature
+  // are candidates. Keying on the answer stops "capital of France" matching
+  // "capital of Spain" just because most of the words are the same.
+  std::vector<uint64_t> answers(questions.size());
+  for (size_t i = 0; i < questions.size(); i++) {
+    answers[i] = question_hash(questions[i]->answer);
+  }
+
+  std::unordered_set<uint64_t> candidates;
+  for (int band = 0; band < BANDS; band++) {
+    std::unordered_map<uint64_t, std::vector<uint32_t>> buckets;
+    for (uint32_t i = 0; i < signatures.size(); i++) {
+      if (signatures[i][0] == UINT64_MAX) {
+        continue; // No words to compare
+      }
+      uint64_t key = answers[i] + band;
+      for (int row = 0; row < BAND_ROWS; row++) {
+        key = mix(key ^ signatures[i][band * BAND_ROWS + row]);
+      }
+      auto & bucket = buckets[key];
+      for (uint32_t j : bucket) {
+        candidates.insert(uint64_t(j) << 32 | i);
+      }
+      bucket.push_back(i);
+    }
+  }
+
+  std::vector<NearDuplicate> duplicates;
+  for (uint64_t pair : candidates) {
+    uint32_t a = pair >> 32, b = pair & UINT32_MAX;
+    float estimate = similarity(signatures[a], signatures[b]);
+    if (estimate >= threshold) {
+      duplicates.push_back({refs[a], refs[b], estimate});
+    }
+  }
+  std::sort(duplicates.begin(), duplicates.end(), [](auto const & x, auto const & y) {
+    return x.similarity > y.similarity;
+  });
+  return duplicates;
+}
+
+BankSnapshot without_near_duplicates(
+  QuestionBank const & bank, std::vector<NearDuplicate> const & duplicates
+) {
+  std::vector<std::vector<bool>> removed;
+  for (auto const & category : bank.categories) {
+    removed.emplace_back(category->questions.size());
+  }
+  for (auto const & duplicate : duplicates) {
+    removed[duplicate.duplicate.category][duplicate.duplicate.question] = true;
+  }
+
+  auto filtered = std::make_shared<QuestionBank>();
+  filtered->generation = bank.generation;
+  for (uint32_t c = 0; c < bank.categories.size(); c++) {
+    auto const & category = *bank.categories[c];
+    if (std::find(removed[c].begin(), removed[c].end(), true) == removed[c].end()) {
+      filtered->categories.push_back(bank.categories[c]);
+      continue;
+    }
+    auto copy = std::make_shared<Category>();
+    copy->name = category.name;
+    copy->source = category.source;
+    for (uint32_t q = 0; q < category.questions.size(); q++) {
+      if (!removed[c][q]) {
+        copy->questions.push_back(category.questions[q]);
+      }
+    }
+    copy->answers = std::make_shared<AnswerIndex>(copy->questions);
+    filtered->categories.push_back(std::move(copy));
+  }
+  return filtered;
+}
@@ -0,0 +1,26 @@
+#ifndef DEDUPE_H_
+#define DEDUPE_H_
+
+#include <vector>
+#include <cstdint>
+
+#include "question_bank.h"
+
+struct NearDuplicate {
+  // `duplicate` comes after `original` in bank order
+  QuestionRef original, duplicate;
+  float similarity;
+};
+
+// Finds question pairs with the same answer whose word shingles have an
+// (estimated) Jaccard similarity of at least `threshold`. MinHash signatures
+// are computed in parallel and candidates come from LSH banding, so this
+// avoids comparing every pair of questions.
+std::vector<NearDuplicate> find_near_duplicates(
+  QuestionBank const & bank, float threshold = 0.5f);
+
+// A copy of the bank with every `duplicate` removed
+BankSnapshot without_near_duplicates(
+  QuestionBank const & bank, std::vector<NearDuplicate> const & duplicates);
+
+#endif
@@ -1,7 +1,19 @@
+#include <cctype>
 #include <iostream>
+#include <stdexcept>
 #include "fonts/due_font.h"
 
 namespace DueUtil::Images {
+  static GlyphBitmap copy_bitmap(FT_Bitmap const & bitmap, int left, int top) {
+    GlyphBitmap copy;
+    copy.width = bitmap.width;
+    copy.rows = bitmap.rows;
+    copy.left = left;
+    copy.top = top;
+    copy.coverage.assign(bitmap.buffer, bitmap.buffer + bitmap.width * bitmap.rows);
+    return copy;
+  }
+
   DueFont::DueFont(std::string const & filepath) {
     initFreetype(m_lib, m_face, filepath.c_str());
     FT_Stroker_New(m_lib, &m_stroker);
@@ -33,6 +45,57 @@ namespace DueUtil::Images {
     return m_stroker;
   }
 
+  Glyph const & DueFont::glyph(char32_t symbol, int size, int stroke) {
+    uint64_t key = uint64_t(symbol) | uint64_t(size) << 32 | uint64_t(stroke) << 48;
+    {
+      std::shared_lock reading(m_glyph_lock);
+      auto cached = m_glyphs.find(key);
+      if (cached != m_glyphs.end()) {
+        return cached->second;
+      }
+    }
+
+    std::unique_lock writing(m_glyph_lock);
+    auto cached = m_glyphs.find(key);
+    if (cached != m_glyphs.end()) {
+      return cached->second;
+    }
+
+    FT_Set_Pixel_Sizes(m_face, 0, size);
+    if (FT_Load_Char(m_face, symbol, FT_LOAD_DEFAULT | FT_LOAD_NO_BITMAP)) {
+      throw std::runtime_error("glyph failed to load");
+    }
+    FT_GlyphSlot slot = m_face->glyph;
+    Glyph glyph;
+    glyph.advance = slot->metrics.horiAdvance >> 6;
+    if (isspace(static_cast<char>(symbol))) {
+      return m_glyphs.emplace(key, std::move(glyph)).first->second;
+    }
+
+    // Placed the same way drawText places them
+    int left = slot->bitmap_left, top = slot->bitmap_top;
+    if (stroke > 0) {
+      FT_Glyph outline;
+      if (FT_Get_Glyph(slot, &outline) != 0) {
+        throw std::runtime_error("can't get glyph");
+      }
+      if (FT_Glyph_StrokeBorder(&outline, this->stroker(stroke), false, true) != 0
+        || FT_Glyph_To_Bitmap(&outline, FT_RENDER_MODE_NORMAL, nullptr, true) != 0
+      ) {
+        FT_Done_Glyph(outline);
+        throw std::runtime_error("stroke failed");
+      }
+      auto stroked = reinterpret_cast<FT_BitmapGlyph>(outline);
+      glyph.stroke = copy_bitmap(stroked->bitmap, left - 1, top + 1);
+      FT_Done_Glyph(outline);
+    }
+    if (FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL) != 0) {
+      throw std::runtime_error("render failed");
+    }
+    glyph.fill = copy_bitmap(slot->bitmap, left, top);
+    return m_glyphs.emplace(key, std::move(glyph)).first->second;
+  }
+
   DueFont::~DueFont() {
     FT_Stroker_Done(m_stroker);
     closeFreetype(m_lib, m_face);
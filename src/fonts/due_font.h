@@ -1,14 +1,38 @@
 #ifndef DUE_FONT_H
 #define DUE_FONT_H
 
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+
 #include "fonts/cimg_freetype.h"
 
 namespace DueUtil::Images {
+  // Glyph coverage as FreeType rendered it, placed relative to the pen
+  // position on the baseline
+  struct GlyphBitmap {
+    std::vector<uint8_t> coverage;
+    int width = 0, rows = 0;
+    int left = 0, top = 0;
+  };
+
+  struct Glyph {
+    GlyphBitmap fill, stroke;
+    int advance = 0;
+  };
+
   class DueFont {
     FT_Library m_lib;
     FT_Face m_face;
     FT_Stroker m_stroker;
 
+    // Keyed on symbol, size and stroke. FreeType is only touched to fill a
+    // miss (under the exclusive lock), so one font can be shared by threads.
+    std::shared_mutex m_glyph_lock;
+    std::unordered_map<uint64_t, Glyph> m_glyphs;
+
     public:
       DueFont(std::string const & filepath);
       DueFont(DueFont const & font);
@@ -19,6 +43,8 @@ namespace DueUtil::Images {
 
       FT_Stroker stroker(int width);
 
+      Glyph const & glyph(char32_t symbol, int size, int stroke = 0);
+
       ~DueFont();
   };
 }
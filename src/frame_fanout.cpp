@@ -0,0 +1,90 @@
+#include <atomic>
+#include <algorithm>
+
+#include "trace.h"
+#include "frame_fanout.h"
+
+SinkWriter::SinkWriter(std::unique_ptr<FrameSink> sink)
+  : sink{std::move(sink)}, sink_format{this->sink->format()}
+{
+  write_thread = std::thread([this]{ write(); });
+}
+
+void SinkWriter::submit(FrameBuffer frame) {
+  {
+    std::lock_guard guard(lock);
+    if (pending) {
+      dropped.add();
+    }
+    pending = std::move(frame);
+  }
+  submitted.notify_one();
+}
+
+void SinkWriter::write() {
+  while (true) {
+    FrameBuffer frame;
+    {
+      std::unique_lock guard(lock);
+      submitted.wait(guard, [&]{ return !running || pending; });
+      if (!running) {
+        return;
+      }
+      frame = std::move(pending);
+    }
+    sink->write(*frame);
+  }
+}
+
+SinkWriter::~SinkWriter() {
+  {
+    std::lock_guard guard(lock);
+    running = false;
+  }
+  submitted.notify_one();
+  write_thread.join();
+}
+
+FrameFanout::FrameFanout(std::vector<std::unique_ptr<FrameSink>> sinks) {
+  for (auto & sink : sinks) {
+    auto format = sink->format();
+    auto output = std::find_if(outputs.begin(), outputs.end(),
+      [&](auto const & o) { return o.format == format; });
+    if (output == outputs.end()) {
+      output = outputs.insert(outputs.end(), Output { format, nullptr, {} });
+    }
+    output->writers.push_back(std::make_unique<SinkWriter>(std::move(sink)));
+  }
+}
+
+void FrameFanout::submit(cimg_library::CImg<uint8_t> const & canvas) {
+  for (auto & output : outputs) {
+    // A buffer a writer still holds is immutable, so only convert in place
+    // once ours is the last reference
+    if (!output.buffer || output.buffer.use_count() > 1) {
+      output.buffer = std::make_shared<std::vector<uint8_t>>();
+    } else {
+      // Pairs with the writer's release when it dropped the buffer
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    {
+      Trace::Span span("convert");
+      Metrics::Timer timer(convert_time);
+      convert_frame(canvas, output.format, *output.buffer);
+    }
+    for (auto & writer : output.writers) {
+      writer->submit(output.buffer);
+    }
+  }
+}
+
+void FrameFanout::resubmit() {
+  for (auto & output : outputs) {
+    if (!output.buffer) {
+      continue;
+    }
+    for (auto & writer : output.writers) {
+      writer->submit(output.buffer);
+    }
+  }
+}
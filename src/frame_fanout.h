@@ -0,0 +1,74 @@
+#ifndef FRAME_FANOUT_H_
+#define FRAME_FANOUT_H_
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+
+#include <CImg.h>
+
+#include "metrics.h"
+#include "frame_sink.h"
+
+// A converted frame, shared by every sink that takes its format
+using FrameBuffer = std::shared_ptr<std::vector<uint8_t> const>;
+
+// Writes to one sink on its own thread. If the sink falls behind only the
+// newest frame is kept, so a slow sink drops frames instead of stalling others.
+class SinkWriter final {
+  std::unique_ptr<FrameSink> sink;
+  FrameFormat sink_format;
+
+  std::mutex lock;
+  std::condition_variable submitted;
+  FrameBuffer pending;
+  bool running = true;
+  std::thread write_thread;
+
+  static inline Metrics::Counter dropped {
+    "quiz_sink_dropped_frames_total", "Frames replaced before a slow sink wrote them" };
+
+  void write();
+
+  public:
+    SinkWriter(std::unique_ptr<FrameSink> sink);
+
+    SinkWriter(SinkWriter const &) = delete;
+    SinkWriter& operator=(SinkWriter const &) = delete;
+
+    FrameFormat format() const { return sink_format; }
+
+    void submit(FrameBuffer frame);
+
+    ~SinkWriter();
+};
+
+// Converts each frame once per distinct format and hands the same buffer to
+// every sink wanting that format
+class FrameFanout final {
+  struct Output {
+    FrameFormat format;
+    // Reused once every writer has let go of it
+    std::shared_ptr<std::vector<uint8_t>> buffer;
+    std::vector<std::unique_ptr<SinkWriter>> writers;
+  };
+  std::vector<Output> outputs;
+
+  static inline Metrics::Histogram convert_time {
+    "quiz_frame_convert_seconds", "Time converting a frame for its outputs" };
+
+  public:
+    FrameFanout(std::vector<std::unique_ptr<FrameSink>> sinks);
+
+    bool empty() const { return outputs.empty(); }
+
+    void submit(cimg_library::CImg<uint8_t> const & canvas);
+
+    // Sends the last converted frames again, for when the canvas is unchanged
+    void resubmit();
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include <cerrno>
+#include <stdexcept>
+
+#include "frame_pacer.h"
+
+static int64_t to_ns(timespec const & time) {
+  return time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+static timespec from_ns(int64_t ns) {
+  return { static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000) };
+}
+
+FramePacer::FramePacer(int fps) {
+  if (fps <= 0) {
+    throw std::runtime_error("Frame rate must be positive!");
+  }
+  period = 1000000000 / fps;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+}
+
+uint32_t FramePacer::wait() {
+  int64_t next = to_ns(deadline) + period;
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  uint32_t skipped = 0;
+  if (to_ns(now) < next) {
+    deadline = from_ns(next);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+  } else {
+    late.add();
+    // Jump to the latest slot that's already due, skipping the rest
+    skipped = (to_ns(now) - next) / period;
+    if (skipped > 0) {
+      missed.add(skipped);
+    }
+    deadline = from_ns(next + skipped * period);
+  }
+  lateness.record(to_ns(now) - to_ns(deadline));
+  return skipped;
+}
+
+bool AdaptiveRate::due(uint64_t generation, clock::time_point now) {
+  if (generation != last_generation) {
+    last_generation = generation;
+    changed = now;
+  }
+  if (keepalive_period == clock::duration::zero() || now - changed < active_window) {
+    sent = now;
+    return true;
+  }
+  if (now - sent >= keepalive_period) {
+    sent = now;
+    keepalives.add();
+    return true;
+  }
+  idle.add();
+  return false;
+}
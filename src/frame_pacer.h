@@ -0,0 +1,57 @@
+#ifndef FRAME_PACER_H_
+#define FRAME_PACER_H_
+
+#include <ctime>
+#include <chrono>
+#include <cstdint>
+
+#include "metrics.h"
+
+// Paces frames against absolute deadlines (start + n / fps), so the time
+// spent rendering and writing a frame doesn't add to the period. A frame
+// that's late goes out straight away, and if whole periods have been lost
+// they're skipped rather than sent in a burst.
+class FramePacer final {
+  int64_t period;
+  timespec deadline;
+
+  static inline Metrics::Counter late {
+    "quiz_late_frames_total", "Frames that started after their deadline" };
+  static inline Metrics::Counter missed {
+    "quiz_missed_deadlines_total", "Frame slots skipped to catch up" };
+  static inline Metrics::Histogram lateness {
+    "quiz_frame_lateness_seconds", "How long after its deadline each frame started" };
+
+  public:
+    FramePacer(int fps);
+
+    int fps() const { return 1000000000 / period; }
+
+    // Waits for the next frame's deadline, returning how many were skipped
+    uint32_t wait();
+};
+
+// Sends every frame for a window after the picture changes, then only as
+// often as the consumer needs to keep the camera alive
+class AdaptiveRate final {
+  using clock = std::chrono::steady_clock;
+
+  clock::duration active_window, keepalive_period;
+  uint64_t last_generation = UINT64_MAX;
+  clock::time_point changed, sent;
+
+  static inline Metrics::Counter keepalives {
+    "quiz_keepalive_frames_total", "Frames sent only to keep an unchanged page alive" };
+  static inline Metrics::Counter idle {
+    "quiz_idle_frames_total", "Frame slots skipped as the page hadn't changed" };
+
+  public:
+    // A zero keepalive period sends every frame
+    AdaptiveRate(clock::duration active_window = {}, clock::duration keepalive_period = {})
+      : active_window{active_window}, keepalive_period{keepalive_period} {}
+
+    // Whether to send a frame now, `generation` changes whenever the picture does
+    bool due(uint64_t generation, clock::time_point now);
+};
+
+#endif
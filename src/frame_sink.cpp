@@ -0,0 +1,222 @@
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "v4l2_cimg.h"
+#include "frame_sink.h"
+#include "recording_sink.h"
+
+using namespace cimg_library;
+
+size_t FrameFormat::size() const {
+  switch (pixels) {
+    case PixelFormat::YUYV:
+      return width * height * 2;
+    case PixelFormat::I420:
+      return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+  }
+  return 0;
+}
+
+void rgb_to_yuyv(CImg<uint8_t> const & canvas, std::vector<uint8_t> & frame_buffer) {
+  bool skip = true;
+  cimg_forXY(canvas, cx, cy) {
+    size_t row = cy * canvas.width() * 2;
+    uint8_t r, g, b;
+    uint8_t y;
+    r = canvas(cx, cy, 0);
+    g = canvas(cx, cy, 1);
+    b = canvas(cx, cy, 2);
+
+    y = std::clamp<uint8_t>(r * .299000 + g * .587000 + b * .114000, 0, 255);
+    frame_buffer[row + cx * 2] = y;
+    if (!skip) {
+      uint8_t u, v;
+      u = std::clamp<uint8_t>(r * -.168736 + g * -.331264 + b * .500000 + 128, 0, 255);
+      v = std::clamp<uint8_t>(r * .500000 + g * -.418688 + b * -.081312 + 128, 0, 255);
+      frame_buffer[row + (cx - 1) * 2 + 1] = u;
+      frame_buffer[row + (cx - 1) * 2 + 3] = v;
+    }
+    skip = !skip;
+  }
+}
+
+void rgb_to_i420(CImg<uint8_t> const & canvas, std::vector<uint8_t> & frame_buffer) {
+  int width = canvas.width(), height = canvas.height();
+  int chroma_width = (width + 1) / 2, chroma_height = (height + 1) / 2;
+  uint8_t * luma = frame_buffer.data();
+  uint8_t * u_plane = luma + width * height;
+  uint8_t * v_plane = u_plane + chroma_width * chroma_height;
+
+  cimg_forXY(canvas, cx, cy) {
+    int r = canvas(cx, cy, 0), g = canvas(cx, cy, 1), b = canvas(cx, cy, 2);
+    luma[cy * width + cx] = std::clamp(r * .299 + g * .587 + b * .114, 0.0, 255.0);
+  }
+  for (int cy = 0; cy < chroma_height; cy++) {
+    for (int cx = 0; cx < chroma_width; cx++) {
+      int x = cx * 2, y = cy * 2;
+      int x1 = std::min(x + 1, width - 1), y1 = std::min(y + 1, height - 1);
+      double rgb[3];
+      for (int c = 0; c < 3; c++) {
+        rgb[c] = (canvas(x, y, c) + canvas(x1, y, c) + canvas(x, y1, c) + canvas(x1, y1, c)) / 4.0;
+      }
+      auto [r, g, b] = rgb;
+      u_plane[cy * chroma_width + cx] =
+        std::clamp(r * -.168736 + g * -.331264 + b * .500000 + 128, 0.0, 255.0);
+      v_plane[cy * chroma_width + cx] =
+        std::clamp(r * .500000 + g * -.418688 + b * -.081312 + 128, 0.0, 255.0);
+    }
+  }
+}
+
+void convert_frame(
+  CImg<uint8_t> const & canvas, FrameFormat const & format,
+  std::vector<uint8_t> & frame_buffer
+) {
+  frame_buffer.resize(format.size());
+  if (canvas.width() != format.width || canvas.height() != format.height) {
+    // Linear interpolation
+    convert_frame(canvas.get_resize(format.width, format.height, 1, 3, 3), format, frame_buffer);
+    return;
+  }
+  switch (format.pixels) {
+    case PixelFormat::YUYV:
+      rgb_to_yuyv(canvas, frame_buffer);
+      break;
+    case PixelFormat::I420:
+      rgb_to_i420(canvas, frame_buffer);
+      break;
+  }
+}
+
+bool write_all(int fd, uint8_t const * data, size_t size) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+void report_failure(bool & failed, char const * sink) {
+  if (!failed) {
+    std::cerr << "Unable to write to " << sink << ": " << std::strerror(errno) << '\n';
+    failed = true;
+  }
+}
+
+RawFileSink::RawFileSink(char const * file, FrameFormat format) : frame_format{format} {
+  if ((fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) == -1) {
+    throw std::runtime_error(std::string("Unable to open ") + file);
+  }
+}
+
+void RawFileSink::write(std::vector<uint8_t> const & frame) {
+  if (!write_all(fd, frame.data(), frame.size())) {
+    report_failure(failed, "raw file");
+  }
+}
+
+RawFileSink::~RawFileSink() {
+  close(fd);
+}
+
+std::string y4m_header(int width, int height, int fps) {
+  return "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height)
+    + " F" + std::to_string(fps) + ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+}
+
+Y4mSink::Y4mSink(int fd, int width, int height, int fps)
+  : fd{fd}, frame_format{PixelFormat::I420, width, height}
+{
+  auto header = y4m_header(width, height, fps);
+  if (!write_all(fd, reinterpret_cast<uint8_t const *>(header.data()), header.size())) {
+    report_failure(failed, "Y4M output");
+  }
+}
+
+void Y4mSink::write(std::vector<uint8_t> const & frame) {
+  static uint8_t const frame_header[] = { 'F', 'R', 'A', 'M', 'E', '\n' };
+  if (!write_all(fd, frame_header, sizeof(frame_header))
+    || !write_all(fd, frame.data(), frame.size())
+  ) {
+    report_failure(failed, "Y4M output");
+  }
+}
+
+Y4mSink::~Y4mSink() {
+  close(fd);
+}
+
+int take_stdout() {
+  static int video_fd = [] {
+    // Failed writes are reported by the sink rather than killing the process
+    signal(SIGPIPE, SIG_IGN);
+    std::cout.flush();
+    int fd = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    return fd;
+  }();
+  return video_fd;
+}
+
+static std::string room_path(std::string_view path, int room) {
+  std::string expanded(path);
+  auto placeholder = expanded.find("{room}");
+  if (placeholder != std::string::npos) {
+    expanded.replace(placeholder, 6, std::to_string(room));
+  }
+  return expanded;
+}
+
+std::unique_ptr<FrameSink> make_sink(
+  std::string_view spec, int width, int height, int fps, int room
+) {
+  auto colon = spec.find(':');
+  auto kind = spec.substr(0, colon);
+  auto path = room_path(colon == std::string_view::npos ? "" : spec.substr(colon + 1), room);
+
+  if (kind == "v4l2" && !path.empty()) {
+    return std::make_unique<v4l2_cimg>(path.c_str(), width, height);
+  }
+  if (kind == "y4m" && !path.empty()) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+      throw std::runtime_error("Unable to open " + path);
+    }
+    return std::make_unique<Y4mSink>(fd, width, height, fps);
+  }
+  if (kind == "raw" && !path.empty()) {
+    return std::make_unique<RawFileSink>(path.c_str(),
+      FrameFormat { PixelFormat::YUYV, width, height });
+  }
+  if (kind == "record" && !path.empty()) {
+    return std::make_unique<RecordingSink>(path, width, height, fps);
+  }
+  if (kind == "pipe") {
+    // Only one sink can own stdout
+    static bool taken = false;
+    if (taken) {
+      throw std::runtime_error("Only one sink can write to stdout!");
+    }
+    taken = true;
+    return std::make_unique<Y4mSink>(take_stdout(), width, height, fps);
+  }
+  if (kind == "null") {
+    return std::make_unique<NullSink>(FrameFormat { PixelFormat::YUYV, width, height });
+  }
+  throw std::runtime_error("Unknown output " + std::string(spec));
+}
@@ -0,0 +1,119 @@
+#ifndef FRAME_SINK_H_
+#define FRAME_SINK_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+#include <CImg.h>
+
+enum class PixelFormat {
+  YUYV, // Packed 4:2:2, what v4l2loopback takes
+  I420  // Planar 4:2:0, what Y4M players expect
+};
+
+struct FrameFormat {
+  PixelFormat pixels;
+  int width, height;
+
+  size_t size() const;
+
+  bool operator==(FrameFormat const &) const = default;
+};
+
+// Packs an RGB canvas into YUYV 4:2:2, frame_buffer must hold width * height * 2
+void rgb_to_yuyv(cimg_library::CImg<uint8_t> const & canvas, std::vector<uint8_t> & frame_buffer);
+
+// Planar 4:2:0 with each chroma sample averaged over a 2x2 block
+void rgb_to_i420(cimg_library::CImg<uint8_t> const & canvas, std::vector<uint8_t> & frame_buffer);
+
+// Converts an RGB canvas into `format`, scaling it first if the size differs
+void convert_frame(
+  cimg_library::CImg<uint8_t> const & canvas, FrameFormat const & format,
+  std::vector<uint8_t> & frame_buffer);
+
+// Somewhere converted frames are written to
+class FrameSink {
+  public:
+    virtual ~FrameSink() = default;
+
+    virtual FrameFormat format() const = 0;
+
+    // `frame` is format().size() bytes
+    virtual void write(std::vector<uint8_t> const & frame) = 0;
+};
+
+// Drops frames, frames are still converted so the pipeline can be measured
+class NullSink final : public FrameSink {
+  FrameFormat frame_format;
+
+  public:
+    NullSink(FrameFormat format) : frame_format{format} {}
+
+    FrameFormat format() const override { return frame_format; }
+
+    void write(std::vector<uint8_t> const &) override {}
+};
+
+// Frames back to back with no header, e.g. for ffmpeg -f rawvideo
+class RawFileSink final : public FrameSink {
+  int fd = -1;
+  FrameFormat frame_format;
+  bool failed = false;
+
+  public:
+    RawFileSink(char const * file, FrameFormat format);
+
+    RawFileSink(RawFileSink const &) = delete;
+    RawFileSink& operator=(RawFileSink const &) = delete;
+
+    FrameFormat format() const override { return frame_format; }
+
+    void write(std::vector<uint8_t> const & frame) override;
+
+    ~RawFileSink();
+};
+
+// YUV4MPEG2 (I420, full range), to a file or a pipe into ffmpeg/ffplay
+class Y4mSink final : public FrameSink {
+  int fd = -1;
+  FrameFormat frame_format;
+  bool failed = false;
+
+  public:
+    // Takes ownership of fd
+    Y4mSink(int fd, int width, int height, int fps);
+
+    Y4mSink(Y4mSink const &) = delete;
+    Y4mSink& operator=(Y4mSink const &) = delete;
+
+    FrameFormat format() const override { return frame_format; }
+
+    void write(std::vector<uint8_t> const & frame) override;
+
+    ~Y4mSink();
+};
+
+// Stream header for full range I420 frames
+std::string y4m_header(int width, int height, int fps);
+
+// Writes all of `data`, retrying short writes and EINTR
+bool write_all(int fd, uint8_t const * data, size_t size);
+
+// Sinks keep running after a failed write (e.g. ffplay was closed), they
+// just say so once
+void report_failure(bool & failed, char const * sink);
+
+// Moves stdout aside for video and points it at stderr, so logging can't end
+// up in the stream. Safe to call more than once, returns the video fd.
+int take_stdout();
+
+// Builds a sink from a spec:
+//   v4l2:<device>  y4m:<file>  raw:<file> (YUYV)  record:<file>  pipe (Y4M on stdout)  null
+// "{room}" in a path is replaced with the room's id.
+std::unique_ptr<FrameSink> make_sink(
+  std::string_view spec, int width, int height, int fps, int room);
+
+#endif
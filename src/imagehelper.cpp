@@ -1,5 +1,6 @@
-
 #include "util.h"
+#include "trace.h"
+#include "metrics.h"
 #include "imagehelper.h"
 #include "fonts/cimg_freetype.h"
 
@@ -8,7 +9,7 @@ namespace DueUtil::Images {
     return rgb[0] * 0.299 + rgb[1] * 0.587 + rgb[2] * 0.114;
   }
 
-  int32_t Colour::to_int() {
+  int32_t Colour::to_int() const {
     int red   = (this->rgb[0] << 16) & 0x00FF0000;
     int green = (this->rgb[1] << 8) & 0x0000FF00;
     int blue  = this->rgb[2] & 0x000000FF;
@@ -24,16 +25,16 @@ namespace DueUtil::Images {
   }
 
   int get_text_limit_length(
-    std::u32string& str, FT_Face fontface, int size, int max_width
+    std::u32string& str, DueFont& font, int size, int max_width
   ) {
     bool removed_chars = false;
-    int ellipsis_width = textWidth(fontface, size, U"…");
+    int ellipsis_width = font.glyph(U'…', size).advance;
 
     int width = 0;
     size_t i;
     max_width = std::max<size_t>(0, max_width - ellipsis_width);
     for (i = 0; i < str.length(); i++) {
-      int new_width = width + charWidth(fontface, size, str[i]);
+      int new_width = width + font.glyph(str[i], size).advance;
       if (new_width > max_width) {
         removed_chars = true;
         break;
@@ -48,6 +49,32 @@ namespace DueUtil::Images {
     return width;
   }
 
+  // Blends coverage in the same way as drawBitmap
+  static void draw_glyph_bitmap(
+    CImg<uint8_t> & canvas, GlyphBitmap const & bitmap, int x, int baseline,
+    uint8_t const colour[]
+  ) {
+    int left = x + bitmap.left, top = baseline - bitmap.top;
+    for (int gy = 0; gy < bitmap.rows; gy++) {
+      int cy = top + gy;
+      if (cy < 0 || cy >= canvas.height()) {
+        continue;
+      }
+      for (int gx = 0; gx < bitmap.width; gx++) {
+        int cx = left + gx;
+        uint8_t coverage = bitmap.coverage[gy * bitmap.width + gx];
+        if (coverage == 0 || cx < 0 || cx >= canvas.width()) {
+          continue;
+        }
+        float alpha = (255 - coverage) / 255.0f;
+        cimg_forC(canvas, c) {
+          canvas(cx, cy, c) = static_cast<uint8_t>(
+            canvas(cx, cy, c) * alpha + colour[c] * (1.0 - alpha));
+        }
+      }
+    }
+  }
+
   void draw_text(
     CImg<uint8_t> & canvas,
     int x, int y,
@@ -59,21 +86,28 @@ namespace DueUtil::Images {
     int stroke,
     Colour const & stroke_colour
   ) {
+    static Metrics::Histogram raster_time(
+      "quiz_text_raster_seconds", "Time drawing a line of text");
+    Metrics::Timer timer(raster_time);
+    Trace::Span span("draw_text");
+
     uint8_t colour_bytes[4];
     uint8_t stroke_colour_bytes[4];
+    colour.as_bytes(colour_bytes);
     stroke_colour.as_bytes(stroke_colour_bytes);
     if (max_len > 0) {
-      (void) get_text_limit_length(text, font.face(), size, max_len);
+      (void) get_text_limit_length(text, font, size, max_len);
+    }
+    // Glyphs come from the font's cache rather than being rendered per call
+    int baseline = y + size - 1;
+    for (char32_t symbol : text) {
+      auto const & glyph = font.glyph(symbol, size, stroke);
+      if (stroke > 0) {
+        draw_glyph_bitmap(canvas, glyph.stroke, x, baseline, stroke_colour_bytes);
+      }
+      draw_glyph_bitmap(canvas, glyph.fill, x, baseline, colour_bytes);
+      x += glyph.advance;
     }
-    drawText(
-      font.face(),
-      canvas,
-      size,
-      text,
-      x, y + size - 1,
-      colour.as_bytes(colour_bytes),
-      stroke > 0 ? font.stroker(stroke) : nullptr,
-      stroke_colour_bytes, 0);
   }
 
   int text_width(
@@ -81,7 +115,11 @@ namespace DueUtil::Images {
     DueFont& font,
     int size
   ) {
-    return textWidth(font.face(), size, text);
+    int width = 0;
+    for (char32_t symbol : text) {
+      width += font.glyph(symbol, size).advance;
+    }
+    return width;
   }
 
   int text_width(
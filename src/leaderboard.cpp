@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "leaderboard.h"
+
+using namespace DueUtil::Images;
+
+#define TITLE_HEIGHT 64
+#define ROW_HEIGHT 28
+#define ROW_TEXT_SIZE 22
+#define MAX_COLUMNS 4
+
+Leaderboard::Leaderboard(int width, int height, TextRunCache & text)
+  : width{width}, height{height}, text{text}, layer(width, height, 1, 4, 0)
+{
+  auto const & title = text.get("Leaderboard", 40, SKYPE_BLUE);
+  draw_text_run(layer, title, (width - title.width) / 2, (TITLE_HEIGHT - 40) / 2);
+}
+
+void Leaderboard::draw_row(int rank) {
+  int rows_per_column = (height - TITLE_HEIGHT) / ROW_HEIGHT;
+  int column_width = width * 0.9 / columns;
+  int x = width * 0.05 + (rank / rows_per_column) * column_width;
+  int y = TITLE_HEIGHT + (rank % rows_per_column) * ROW_HEIGHT;
+
+  layer.draw_rectangle(x, y, 0, 0, x + column_width - 1, y + ROW_HEIGHT - 1, 0, 3, 0);
+  if (rank >= static_cast<int>(rows.size())) {
+    return;
+  }
+
+  auto const & [team, score] = rows[rank];
+  auto const & position = text.get(std::to_string(rank + 1) + ".", ROW_TEXT_SIZE, QUESTION_ORANGE);
+  auto const & points = text.get(std::to_string(score), ROW_TEXT_SIZE, WHITE);
+  auto const & name = text.get(team, ROW_TEXT_SIZE, ANSWER_PINK);
+
+  int name_x = x + ROW_TEXT_SIZE * 2;
+  int points_x = x + column_width - points.width - ROW_TEXT_SIZE / 2;
+  draw_text_run(layer, position, x, y);
+  draw_text_run(layer, points, points_x, y);
+
+  // Long names are clipped before the score rather than re-rasterised
+  int visible = std::max(1, points_x - name_x - ROW_TEXT_SIZE / 2);
+  if (name.width > visible) {
+    TextRun clipped = name;
+    clipped.pixels.crop(0, 0, name.origin_x + visible - 1, name.pixels.height() - 1);
+    draw_text_run(layer, clipped, name_x, y);
+  } else {
+    draw_text_run(layer, name, name_x, y);
+  }
+}
+
+void Leaderboard::update(std::vector<std::pair<std::string, int>> const & scores) {
+  int rows_per_column = (height - TITLE_HEIGHT) / ROW_HEIGHT;
+  int shown = std::min<int>(scores.size(), rows_per_column * MAX_COLUMNS);
+  int needed_columns = std::max(1, (shown + rows_per_column - 1) / rows_per_column);
+
+  std::vector<Row> updated;
+  for (int i = 0; i < shown; i++) {
+    updated.push_back({ scores[i].first, scores[i].second });
+  }
+
+  // A new column count moves every row, otherwise only changed rows move
+  bool relayout = needed_columns != columns;
+  columns = needed_columns;
+  if (relayout) {
+    layer.draw_rectangle(0, TITLE_HEIGHT, 0, 0, width - 1, height - 1, 0, 3, 0);
+  }
+  size_t drawn = std::max(rows.size(), updated.size());
+  std::swap(rows, updated);
+
+  rows_redrawn = 0;
+  for (size_t rank = 0; rank < drawn; rank++) {
+    bool changed = relayout || rank >= rows.size() || rank >= updated.size()
+      || !(rows[rank] == updated[rank]);
+    if (changed) {
+      draw_row(rank);
+      rows_redrawn += 1;
+    }
+  }
+}
+
+void Leaderboard::draw(cimg_library::CImg<uint8_t> & canvas) const {
+  cimg_forXY(layer, x, y) {
+    uint8_t alpha = layer(x, y, 3);
+    if (alpha == 0) {
+      continue;
+    }
+    for (int c = 0; c < 3; c++) {
+      canvas(x, y, c) = layer(x, y, c) + canvas(x, y, c) * (255 - alpha) / 255;
+    }
+  }
+}
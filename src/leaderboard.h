@@ -0,0 +1,44 @@
+#ifndef LEADERBOARD_H_
+#define LEADERBOARD_H_
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <CImg.h>
+
+#include "colour.h"
+#include "text_run_cache.h"
+
+// Team scores kept rasterised in a layer. Updating only redraws the rows
+// whose rank, team or score changed, using cached text runs.
+class Leaderboard final {
+  struct Row {
+    std::string team;
+    int score;
+    bool operator==(Row const &) const = default;
+  };
+
+  int width, height;
+  DueUtil::Images::TextRunCache & text;
+  cimg_library::CImg<uint8_t> layer;
+
+  std::vector<Row> rows;
+  int columns = 0;
+  int rows_redrawn = 0;
+
+  void draw_row(int rank);
+
+  public:
+    Leaderboard(int width, int height, DueUtil::Images::TextRunCache & text);
+
+    void update(std::vector<std::pair<std::string, int>> const & scores);
+
+    // Composites the rasterised rows onto an RGB canvas
+    void draw(cimg_library::CImg<uint8_t> & canvas) const;
+
+    // How many rows the last update had to redraw
+    int last_redrawn() const { return rows_redrawn; }
+};
+
+#endif
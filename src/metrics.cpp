@@ -0,0 +1,161 @@
+#include <mutex>
+#include <array>
+#include <memory>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+#include "metrics.h"
+
+#define SUB_BUCKET_BITS 3
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+// Up to 2^36ns, about 68 seconds
+#define MAX_EXPONENT 36
+#define BUCKETS ((MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS)
+// Enough for a few dozen metrics
+#define MAX_SLOTS 4096
+
+namespace Metrics {
+  namespace {
+    struct Definition {
+      std::string name, help;
+      uint32_t slot;
+      bool histogram;
+    };
+
+    // Only the owning thread writes a shard, other threads only read it
+    struct Shard {
+      std::array<std::atomic<uint64_t>, MAX_SLOTS> slots {};
+    };
+
+    struct Registry {
+      std::mutex lock;
+      std::vector<Definition> definitions;
+      uint32_t slots_used = 0;
+      // Shards outlive their threads so nothing recorded is lost
+      std::vector<std::unique_ptr<Shard>> shards;
+    };
+
+    Registry & registry() {
+      static Registry registry;
+      return registry;
+    }
+
+    uint32_t define(char const * name, char const * help, bool histogram) {
+      auto & metrics = registry();
+      std::lock_guard guard(metrics.lock);
+      uint32_t slot = metrics.slots_used;
+      // Histograms keep their buckets, then the count and sum
+      metrics.slots_used += histogram ? BUCKETS + 2 : 1;
+      if (metrics.slots_used > MAX_SLOTS) {
+        throw std::runtime_error("Too many metrics!");
+      }
+      metrics.definitions.push_back({ name, help, slot, histogram });
+      return slot;
+    }
+
+    Shard & local_shard() {
+      thread_local Shard * shard = [] {
+        auto & metrics = registry();
+        std::lock_guard guard(metrics.lock);
+        return metrics.shards.emplace_back(std::make_unique<Shard>()).get();
+      }();
+      return *shard;
+    }
+
+    void bump(uint32_t slot, uint64_t amount) {
+      // Single writer, so a relaxed load and store is enough
+      auto & value = local_shard().slots[slot];
+      value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    uint32_t bucket(uint64_t value) {
+      if (value < SUB_BUCKETS) {
+        return value;
+      }
+      int exponent = 63 - __builtin_clzll(value);
+      if (exponent > MAX_EXPONENT) {
+        return BUCKETS - 1;
+      }
+      uint32_t sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+      return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+    }
+
+    // The largest value in a bucket
+    uint64_t bucket_bound(uint32_t index) {
+      if (index < SUB_BUCKETS) {
+        return index;
+      }
+      int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+      uint64_t sub_bucket = index % SUB_BUCKETS;
+      return ((SUB_BUCKETS + sub_bucket + 1) << (exponent - SUB_BUCKET_BITS)) - 1;
+    }
+  }
+
+  Counter::Counter(char const * name, char const * help)
+    : slot{define(name, help, false)} {}
+
+  void Counter::add(uint64_t count) {
+    bump(slot, count);
+  }
+
+  Histogram::Histogram(char const * name, char const * help)
+    : slot{define(name, help, true)} {}
+
+  void Histogram::record(uint64_t nanoseconds) {
+    bump(slot + bucket(nanoseconds), 1);
+    bump(slot + BUCKETS, 1);
+    bump(slot + BUCKETS + 1, nanoseconds);
+  }
+
+  std::string exposition() {
+    auto & metrics = registry();
+    std::lock_guard guard(metrics.lock);
+
+    auto total = [&](uint32_t slot) {
+      uint64_t sum = 0;
+      for (auto const & shard : metrics.shards) {
+        sum += shard->slots[slot].load(std::memory_order_relaxed);
+      }
+      return sum;
+    };
+
+    std::ostringstream out;
+    for (auto const & metric : metrics.definitions) {
+      out << "# HELP " << metric.name << ' ' << metric.help << '\n';
+      if (!metric.histogram) {
+        out << "# TYPE " << metric.name << " counter\n"
+            << metric.name << ' ' << total(metric.slot) << '\n';
+        continue;
+      }
+
+      // Only buckets that have something in them are listed
+      out << "# TYPE " << metric.name << " histogram\n";
+      uint64_t cumulative = 0;
+      for (uint32_t b = 0; b < BUCKETS; b++) {
+        uint64_t count = total(metric.slot + b);
+        if (count == 0) {
+          continue;
+        }
+        cumulative += count;
+        out << metric.name << "_bucket{le=\"" << bucket_bound(b) / 1e9 << "\"} "
+            << cumulative << '\n';
+      }
+      out << metric.name << "_bucket{le=\"+Inf\"} " << total(metric.slot + BUCKETS) << '\n'
+          << metric.name << "_sum " << total(metric.slot + BUCKETS + 1) / 1e9 << '\n'
+          << metric.name << "_count " << total(metric.slot + BUCKETS) << '\n';
+    }
+
+    // For checking what the frame rate settings cost
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    out << "# HELP process_cpu_seconds_total User and system CPU time\n"
+        << "# TYPE process_cpu_seconds_total counter\n"
+        << "process_cpu_seconds_total " << cpu << '\n';
+    return out.str();
+  }
+}
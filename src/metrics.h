@@ -0,0 +1,54 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Counters and histograms for the frame pipeline, exposed in Prometheus' text
+// format. Each thread updates its own shard with relaxed atomics, so recording
+// never takes a lock or shares a cache line; exposition sums the shards.
+namespace Metrics {
+  class Counter final {
+    uint32_t slot;
+
+    public:
+      Counter(char const * name, char const * help);
+
+      void add(uint64_t count = 1);
+  };
+
+  // Log-linear buckets of nanoseconds (8 per power of two, so within 12.5%)
+  // up to about a minute, like an HDR histogram with 1 significant digit
+  class Histogram final {
+    uint32_t slot;
+
+    public:
+      Histogram(char const * name, char const * help);
+
+      void record(uint64_t nanoseconds);
+
+      void record(std::chrono::steady_clock::duration duration) {
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+      }
+  };
+
+  // Records how long its scope took
+  class Timer final {
+    Histogram & histogram;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+      Timer(Histogram & histogram) : histogram{histogram} {}
+
+      ~Timer() {
+        histogram.record(std::chrono::steady_clock::now() - start);
+      }
+  };
+
+  // Every metric so far, summed over all threads
+  std::string exposition();
+}
+
+#endif
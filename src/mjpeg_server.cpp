@@ -0,0 +1,134 @@
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "mjpeg_server.h"
+
+#define BOUNDARY "preview-frame"
+#define POLL_TIMEOUT_MS 100
+// Viewers that can't take a frame (or don't send a request) in this long are dropped
+#define SEND_TIMEOUT_S 2
+// Each viewer costs a thread
+#define MAX_VIEWERS 32
+
+static bool send_all(int fd, char const * data, size_t size) {
+  while (size > 0) {
+    ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+static bool send_all(int fd, std::string const & data) {
+  return send_all(fd, data.data(), data.size());
+}
+
+static bool send_frame(int fd, std::string const & jpeg) {
+  std::string part_header =
+    "--" BOUNDARY "\r\n"
+    "Content-Type: image/jpeg\r\n"
+    "Content-Length: " + std::to_string(jpeg.size()) + "\r\n\r\n";
+  return send_all(fd, part_header) && send_all(fd, jpeg) && send_all(fd, "\r\n", 2);
+}
+
+MjpegServer::MjpegServer(PreviewEncoder & preview, int port) : preview{preview} {
+  if ((listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) == -1) {
+    throw std::runtime_error("Unable to open preview socket!");
+  }
+  int reuse = 1;
+  setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1
+    || listen(listen_fd, 8) == -1
+  ) {
+    close(listen_fd);
+    throw std::runtime_error("Unable to listen on preview port " + std::to_string(port));
+  }
+  accept_thread = std::thread([this]{ accept_viewers(); });
+}
+
+void MjpegServer::accept_viewers() {
+  pollfd listening { listen_fd, POLLIN, 0 };
+  while (running) {
+    viewers.remove_if([](auto const & viewer) {
+      if (viewer->finished) {
+        viewer->thread.join();
+        close(viewer->fd);
+        return true;
+      }
+      return false;
+    });
+
+    if (poll(&listening, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd == -1) {
+      continue;
+    }
+    if (viewers.size() >= MAX_VIEWERS) {
+      close(fd);
+      continue;
+    }
+    timeval timeout { SEND_TIMEOUT_S, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    auto & viewer = *viewers.emplace_back(std::make_unique<Viewer>());
+    viewer.fd = fd;
+    viewer.thread = std::thread([this, &viewer]{ serve(viewer); });
+  }
+}
+
+void MjpegServer::serve(Viewer & viewer) {
+  // Whatever was asked for gets the stream, so just drain the request
+  char request[2048];
+  std::string header =
+    "HTTP/1.0 200 OK\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=" BOUNDARY "\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n\r\n";
+  bool connected = recv(viewer.fd, request, sizeof(request), 0) > 0
+    && send_all(viewer.fd, header);
+
+  // New viewers get the current frame straight away, after that only the
+  // newest frame is sent whenever the last one has gone
+  uint64_t sent_generation = 0;
+  while (connected && running) {
+    auto frame = preview.frame_after(sent_generation, std::chrono::milliseconds(POLL_TIMEOUT_MS));
+    if (!frame.jpeg || frame.generation == sent_generation) {
+      continue;
+    }
+    connected = send_frame(viewer.fd, *frame.jpeg);
+    sent_generation = frame.generation;
+  }
+  // Closed once the thread's joined, so shutdown() never hits a reused fd
+  viewer.finished = true;
+}
+
+MjpegServer::~MjpegServer() {
+  running = false;
+  if (accept_thread.joinable()) {
+    accept_thread.join();
+  }
+  for (auto & viewer : viewers) {
+    // Wakes a viewer blocked sending
+    shutdown(viewer->fd, SHUT_RDWR);
+    viewer->thread.join();
+    close(viewer->fd);
+  }
+  close(listen_fd);
+}
@@ -0,0 +1,42 @@
+#ifndef MJPEG_SERVER_H_
+#define MJPEG_SERVER_H_
+
+#include <list>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "preview_encoder.h"
+
+// Streams preview frames as multipart/x-mixed-replace to any number of
+// viewers. Crow can't stream a response, so this is a tiny server of its own.
+// Each viewer has its own thread that sends the newest frame whenever it's
+// ready for one, so a slow or silent viewer only holds up itself.
+class MjpegServer final {
+  struct Viewer {
+    int fd;
+    std::atomic<bool> finished = false;
+    std::thread thread;
+  };
+
+  PreviewEncoder & preview;
+
+  int listen_fd = -1;
+  std::atomic<bool> running = true;
+  // Only touched by the accept thread until it's joined
+  std::list<std::unique_ptr<Viewer>> viewers;
+  std::thread accept_thread;
+
+  void accept_viewers();
+  void serve(Viewer & viewer);
+
+  public:
+    MjpegServer(PreviewEncoder & preview, int port);
+
+    MjpegServer(MjpegServer const &) = delete;
+    MjpegServer& operator=(MjpegServer const &) = delete;
+
+    ~MjpegServer();
+};
+
+#endif
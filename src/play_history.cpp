@@ -0,0 +1,78 @@
+#include <ctime>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+
+#include "play_history.h"
+
+BloomFilter::BloomFilter(int bits_log2, int hashes)
+  : bits((1ull << bits_log2) / 64), mask{(1ull << bits_log2) - 1}, hashes{hashes} {}
+
+// Double hashing, the two halves of the content hash give every probe
+void BloomFilter::insert(uint64_t hash) {
+  uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+  for (int i = 0; i < hashes; i++, h1 += h2) {
+    bits[(h1 & mask) / 64] |= 1ull << (h1 % 64);
+  }
+}
+
+bool BloomFilter::contains(uint64_t hash) const {
+  uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+  for (int i = 0; i < hashes; i++, h1 += h2) {
+    if (!(bits[(h1 & mask) / 64] & (1ull << (h1 % 64)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+PlayHistory::PlayHistory(std::filesystem::path const & file) {
+  std::ifstream existing(file);
+  std::string line;
+  int loaded = 0;
+  while (std::getline(existing, line)) {
+    std::istringstream entry(line);
+    uint64_t hash;
+    std::time_t played_at;
+    std::string category;
+    if (entry >> std::hex >> hash >> std::dec >> played_at) {
+      seen.insert(hash);
+      std::getline(entry >> std::ws, category);
+      auto & last = category_played[category];
+      last = std::max(last, played_at);
+      loaded += 1;
+    }
+  }
+  std::cout << "Loaded " << loaded << " played questions from " << file << "\n\n";
+
+  log.open(file, std::ios::app);
+  if (!log) {
+    throw std::runtime_error("Unable to open play history " + file.string());
+  }
+}
+
+void PlayHistory::add(QuestionBank const & bank) {
+  std::lock_guard guard(lock);
+  for (auto const & category : bank.categories) {
+    for (auto const & question : category->questions) {
+      seen.insert(question.hash);
+    }
+  }
+}
+
+std::time_t PlayHistory::last_played(std::string const & category) const {
+  std::lock_guard guard(lock);
+  auto played = category_played.find(category);
+  return played != category_played.end() ? played->second : 0;
+}
+
+void PlayHistory::record(Question const & question, std::string const & category) {
+  auto now = std::time(nullptr);
+  std::lock_guard guard(lock);
+  seen.insert(question.hash);
+  category_played[category] = now;
+  records += 1;
+  log << std::hex << std::setw(16) << std::setfill('0') << question.hash
+      << std::dec << ' ' << now << ' ' << category << std::endl;
+}
@@ -0,0 +1,62 @@
+#ifndef PLAY_HISTORY_H_
+#define PLAY_HISTORY_H_
+
+#include <ctime>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+
+#include "question_bank.h"
+
+// Fixed size set membership, false positives only mean a question is skipped
+class BloomFilter final {
+  std::vector<uint64_t> bits;
+  uint64_t mask;
+  int hashes;
+
+  public:
+    BloomFilter(int bits_log2 = 20, int hashes = 7);
+
+    void insert(uint64_t hash);
+    bool contains(uint64_t hash) const;
+};
+
+// Every question shown, across all sessions. The history file is append-only
+// ("<hash> <unix time> <category>" per line), but only a fixed size filter is
+// kept in memory (plus when each category was last played) however long it grows.
+class PlayHistory final {
+  // Rooms record and check from their own threads
+  mutable std::mutex lock;
+  BloomFilter seen;
+  std::ofstream log;
+  std::unordered_map<std::string, std::time_t> category_played;
+  uint64_t records = 0;
+
+  public:
+    PlayHistory(std::filesystem::path const & file);
+
+    // Mark a bank as played without logging it (e.g. last week's questions)
+    void add(QuestionBank const & bank);
+
+    bool played(Question const & question) const {
+      std::lock_guard guard(lock);
+      return seen.contains(question.hash);
+    }
+
+    // 0 if the category has never been played
+    std::time_t last_played(std::string const & category) const;
+
+    // Changes whenever a question is recorded
+    uint64_t version() const {
+      std::lock_guard guard(lock);
+      return records;
+    }
+
+    void record(Question const & question, std::string const & category);
+};
+
+#endif
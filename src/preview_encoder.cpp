@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <vector>
+#include <stdexcept>
+
+#include <jpeglib.h>
+
+#include "preview_encoder.h"
+
+std::string encode_jpeg(cimg_library::CImg<uint8_t> const & image, int quality) {
+  jpeg_compress_struct compress;
+  jpeg_error_mgr errors;
+  compress.err = jpeg_std_error(&errors);
+  jpeg_create_compress(&compress);
+
+  unsigned char * buffer = nullptr;
+  unsigned long size = 0;
+  jpeg_mem_dest(&compress, &buffer, &size);
+
+  compress.image_width = image.width();
+  compress.image_height = image.height();
+  compress.input_components = 3;
+  compress.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&compress);
+  jpeg_set_quality(&compress, quality, TRUE);
+  jpeg_start_compress(&compress, TRUE);
+
+  // CImg stores planes, libjpeg wants interleaved rows
+  std::vector<JSAMPLE> row(image.width() * 3);
+  while (compress.next_scanline < compress.image_height) {
+    int y = compress.next_scanline;
+    for (int x = 0; x < image.width(); x++) {
+      for (int c = 0; c < 3; c++) {
+        row[x * 3 + c] = image(x, y, 0, c);
+      }
+    }
+    JSAMPROW rows[] = { row.data() };
+    jpeg_write_scanlines(&compress, rows, 1);
+  }
+
+  jpeg_finish_compress(&compress);
+  jpeg_destroy_compress(&compress);
+  std::string jpeg(reinterpret_cast<char const *>(buffer), size);
+  free(buffer);
+  return jpeg;
+}
+
+PreviewEncoder::PreviewEncoder(int quality) : quality{quality} {
+  encode_thread = std::thread([this]{ encode(); });
+}
+
+void PreviewEncoder::submit(cimg_library::CImg<uint8_t> const & canvas) {
+  {
+    std::lock_guard guard(lock);
+    pending.assign(canvas);
+    pending_generation += 1;
+  }
+  submitted.notify_one();
+}
+
+void PreviewEncoder::encode() {
+  cimg_library::CImg<uint8_t> image;
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock guard(lock);
+      submitted.wait(guard, [&]{ return !running || pending_generation != generation; });
+      if (!running) {
+        return;
+      }
+      // Take the newest frame, anything older was never encoded
+      image.swap(pending);
+      generation = pending_generation;
+    }
+    auto jpeg = std::make_shared<std::string const>(encode_jpeg(image, quality));
+    {
+      std::lock_guard guard(lock);
+      latest = { generation, std::move(jpeg) };
+    }
+    encoded.notify_all();
+  }
+}
+
+PreviewFrame PreviewEncoder::frame() {
+  std::lock_guard guard(lock);
+  return latest;
+}
+
+PreviewFrame PreviewEncoder::frame_after(
+  uint64_t generation, std::chrono::milliseconds timeout
+) {
+  std::unique_lock guard(lock);
+  encoded.wait_for(guard, timeout, [&]{ return latest.generation > generation; });
+  return latest;
+}
+
+PreviewEncoder::~PreviewEncoder() {
+  {
+    std::lock_guard guard(lock);
+    running = false;
+  }
+  submitted.notify_one();
+  if (encode_thread.joinable()) {
+    encode_thread.join();
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef PREVIEW_ENCODER_H_
+#define PREVIEW_ENCODER_H_
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <condition_variable>
+
+#include <CImg.h>
+
+struct PreviewFrame {
+  // Bumped for every rendered frame, 0 before the first
+  uint64_t generation = 0;
+  std::shared_ptr<std::string const> jpeg;
+};
+
+// JPEG encodes rendered frames on a background thread. Frames submitted while
+// one is being encoded are coalesced, and every viewer shares the encoded bytes.
+class PreviewEncoder final {
+  int quality;
+
+  std::mutex lock;
+  std::condition_variable submitted, encoded;
+  cimg_library::CImg<uint8_t> pending;
+  uint64_t pending_generation = 0;
+  PreviewFrame latest;
+  bool running = true;
+  std::thread encode_thread;
+
+  void encode();
+
+  public:
+    PreviewEncoder(int quality = 80);
+
+    PreviewEncoder(PreviewEncoder const &) = delete;
+    PreviewEncoder& operator=(PreviewEncoder const &) = delete;
+
+    // Copies the canvas, the encoding happens later
+    void submit(cimg_library::CImg<uint8_t> const & canvas);
+
+    PreviewFrame frame();
+
+    // Waits up to `timeout` for a frame newer than `generation`, returning
+    // the latest frame either way
+    PreviewFrame frame_after(uint64_t generation, std::chrono::milliseconds timeout);
+
+    ~PreviewEncoder();
+};
+
+std::string encode_jpeg(cimg_library::CImg<uint8_t> const & image, int quality);
+
+#endif
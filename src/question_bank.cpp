@@ -0,0 +1,124 @@
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "answer_index.h"
+#include "search_index.h"
+#include "question_bank.h"
+#include "rapidjson/istreamwrapper.h"
+
+uint64_t question_hash(std::string_view text) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (unsigned char c : text) {
+    if (std::isalnum(c) || c >= 0x80) {
+      hash ^= std::tolower(c);
+      hash *= 0x100000001b3;
+    }
+  }
+  return hash;
+}
+
+rapidjson::Document load_json_file(std::string path) {
+  std::ifstream ifs(path);
+  rapidjson::IStreamWrapper isw(ifs);
+  rapidjson::Document d;
+  d.ParseStream(isw);
+  return d;
+}
+
+CategoryPtr load_category(std::filesystem::path const & path) {
+  auto category_json = load_json_file(path);
+  if (category_json.HasParseError() || !category_json.IsArray()) {
+    throw std::runtime_error("Unable to parse " + path.string());
+  }
+
+  auto category = std::make_shared<Category>();
+  category->source = path;
+  category->name = path.stem().string();
+  boost::replace_all(category->name, "\"", "");
+
+  std::cout << "Loading " << category->name << " questions!\n";
+  for (Question question : category_json.GetArray()) {
+    std::cout << '\t' << question.question << '\n';
+    question.hash = question_hash(question.question);
+    category->questions.push_back(question);
+  }
+  category->answers = std::make_shared<AnswerIndex>(category->questions);
+  std::cout << '\n';
+  return category;
+}
+
+BankSnapshot load_question_bank(std::filesystem::path const & directory) {
+  // Sorted so a seeded quiz picks the same questions on every machine
+  std::vector<std::filesystem::path> files;
+  for (auto const & entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".json") {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  auto bank = std::make_shared<QuestionBank>();
+  for (auto const & file : files) {
+    bank->categories.push_back(load_category(file));
+  }
+  return bank;
+}
+
+LiveQuestionBank::LiveQuestionBank(BankSnapshot initial) {
+  auto indexed = std::make_shared<QuestionBank>(*initial);
+  indexed->index = std::make_shared<SearchIndex>(*indexed);
+  current.store(std::move(indexed));
+}
+
+void LiveQuestionBank::publish(std::vector<CategoryPtr> categories) {
+  auto next = std::make_shared<QuestionBank>();
+  next->generation = snapshot()->generation + 1;
+  next->categories = std::move(categories);
+  next->index = std::make_shared<SearchIndex>(*next);
+  current.store(std::move(next), std::memory_order_release);
+}
+
+void LiveQuestionBank::replace_category(CategoryPtr category, BankFilter const & filter) {
+  std::lock_guard guard(publish_lock);
+  auto categories = snapshot()->categories;
+  auto existing = std::find_if(categories.begin(), categories.end(),
+    [&](auto const & c) { return c->source == category->source; });
+  if (existing != categories.end()) {
+    *existing = std::move(category);
+  } else {
+    categories.push_back(std::move(category));
+  }
+  if (filter) {
+    QuestionBank candidate;
+    candidate.categories = std::move(categories);
+    categories = filter(candidate)->categories;
+  }
+  publish(std::move(categories));
+}
+
+void LiveQuestionBank::replace_all(std::vector<CategoryPtr> categories, BankFilter const & filter) {
+  std::lock_guard guard(publish_lock);
+  if (filter) {
+    QuestionBank candidate;
+    candidate.categories = std::move(categories);
+    categories = filter(candidate)->categories;
+  }
+  publish(std::move(categories));
+}
+
+void LiveQuestionBank::remove_category(std::filesystem::path const & source) {
+  std::lock_guard guard(publish_lock);
+  auto categories = snapshot()->categories;
+  auto removed = std::remove_if(categories.begin(), categories.end(),
+    [&](auto const & c) { return c->source == source; });
+  if (removed == categories.end()) {
+    return;
+  }
+  categories.erase(removed, categories.end());
+  publish(std::move(categories));
+}
@@ -0,0 +1,96 @@
+#ifndef QUESTION_BANK_H_
+#define QUESTION_BANK_H_
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+#include "json_wrapper.h"
+
+namespace json = SleepyDiscord::json;
+
+struct Question {
+  JSONStructCtor(Question)
+  std::string question;
+  std::string answer;
+  // Content hash of the question text, filled in at load time
+  uint64_t hash = 0;
+
+  JSONStructStart
+    std::make_tuple(
+      json::pair(&Question::question, "Quiz question", json::REQUIRIED_FIELD),
+      json::pair(&Question::answer  , "Answer"       , json::REQUIRIED_FIELD)
+    );
+  JSONStructEnd
+};
+
+class AnswerIndex;
+
+struct Category {
+  std::string name;
+  std::filesystem::path source;
+  std::vector<Question> questions;
+  // Built once the questions are loaded
+  std::shared_ptr<AnswerIndex const> answers;
+};
+
+using CategoryPtr = std::shared_ptr<Category const>;
+
+struct QuestionRef {
+  uint32_t category;
+  uint32_t question;
+};
+
+class SearchIndex;
+
+// A snapshot of every loaded category. Once published it's never modified,
+// a reload publishes a new snapshot that shares the unchanged categories.
+struct QuestionBank {
+  uint64_t generation = 0;
+  std::vector<CategoryPtr> categories;
+  // Built when the snapshot is published
+  std::shared_ptr<SearchIndex const> index;
+};
+
+using BankSnapshot = std::shared_ptr<QuestionBank const>;
+
+// Applied to a bank before it's published, e.g. to drop near-duplicates
+using BankFilter = std::function<BankSnapshot(QuestionBank const &)>;
+
+// FNV-1a over the lowercased letters and digits, so whitespace, punctuation
+// and case edits don't make a question look new
+uint64_t question_hash(std::string_view text);
+
+rapidjson::Document load_json_file(std::string path);
+
+CategoryPtr load_category(std::filesystem::path const & path);
+
+BankSnapshot load_question_bank(std::filesystem::path const & directory);
+
+class LiveQuestionBank final {
+  std::atomic<BankSnapshot> current;
+  // Only serialises writers, readers just load the current snapshot.
+  std::mutex publish_lock;
+
+  void publish(std::vector<CategoryPtr> categories);
+
+  public:
+    LiveQuestionBank(BankSnapshot initial);
+
+    BankSnapshot snapshot() const {
+      return current.load(std::memory_order_acquire);
+    }
+
+    void replace_category(CategoryPtr category, BankFilter const & filter = {});
+    // Swaps in a whole new set of categories, e.g. after a rescan
+    void replace_all(std::vector<CategoryPtr> categories, BankFilter const & filter = {});
+    void remove_category(std::filesystem::path const & source);
+};
+
+#endif
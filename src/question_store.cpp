@@ -0,0 +1,215 @@
+#include <ctime>
+#include <cctype>
+#include <iostream>
+#include <stdexcept>
+
+#include "answer_index.h"
+#include "question_store.h"
+
+namespace {
+  char const * const SCHEMA = R"(
+    CREATE TABLE IF NOT EXISTS questions (
+      id          INTEGER PRIMARY KEY,
+      category    TEXT    NOT NULL,
+      question    TEXT    NOT NULL,
+      answer      TEXT    NOT NULL,
+      hash        INTEGER NOT NULL UNIQUE,
+      last_played INTEGER NOT NULL DEFAULT 0
+    );
+    CREATE INDEX IF NOT EXISTS questions_by_category
+      ON questions (category, last_played);
+    CREATE INDEX IF NOT EXISTS questions_by_last_played
+      ON questions (last_played);
+    CREATE VIRTUAL TABLE IF NOT EXISTS question_text USING fts5(
+      question, answer, content='questions', content_rowid='id');
+    CREATE TRIGGER IF NOT EXISTS question_text_insert AFTER INSERT ON questions BEGIN
+      INSERT INTO question_text (rowid, question, answer)
+        VALUES (new.id, new.question, new.answer);
+    END;
+  )";
+
+  // Picks random categories and ranks each one's questions least recently
+  // played first (ties broken randomly). Rows come in the categories' drawn
+  // order, every question of a category is returned so multiple choice has
+  // all its answers to pick distractors from.
+  char const * const SELECT_QUIZ = R"(
+    WITH picked AS (
+      SELECT category, random() AS draw FROM (SELECT DISTINCT category FROM questions)
+      ORDER BY draw LIMIT ?1
+    ), ranked AS (
+      SELECT category, draw, question, answer, hash, row_number() OVER (
+        PARTITION BY category ORDER BY last_played, random()) AS position
+      FROM questions JOIN picked USING (category)
+    )
+    SELECT category, question, answer, hash FROM ranked ORDER BY draw, position
+  )";
+
+  char const * const SEARCH = R"(
+    SELECT questions.id, category, questions.question, questions.answer, hash
+    FROM question_text JOIN questions ON questions.id = question_text.rowid
+    WHERE question_text MATCH ?1 ORDER BY rank LIMIT ?2
+  )";
+
+  std::string column_text(sqlite3_stmt * statement, int column) {
+    auto text = reinterpret_cast<char const *>(sqlite3_column_text(statement, column));
+    return std::string(text, sqlite3_column_bytes(statement, column));
+  }
+}
+
+QuestionStore::QuestionStore(std::filesystem::path const & file) {
+  if (sqlite3_open(file.c_str(), &db) != SQLITE_OK) {
+    std::string error = sqlite3_errmsg(db);
+    sqlite3_close(db);
+    throw std::runtime_error("Unable to open question store: " + error);
+  }
+  // Stores made before the search index existed need it filled in
+  auto find_index = prepare("SELECT 1 FROM sqlite_master WHERE name = 'question_text'");
+  bool indexed = sqlite3_step(find_index) == SQLITE_ROW;
+  sqlite3_finalize(find_index);
+  exec(SCHEMA);
+  if (!indexed) {
+    exec("INSERT INTO question_text (question_text) VALUES ('rebuild')");
+  }
+  insert_question = prepare(
+    "INSERT OR IGNORE INTO questions (category, question, answer, hash) VALUES (?, ?, ?, ?)");
+  select_quiz = prepare(SELECT_QUIZ);
+  update_played = prepare("UPDATE questions SET last_played = ? WHERE hash = ?");
+  search_text = prepare(SEARCH);
+}
+
+void QuestionStore::exec(char const * sql) {
+  char * error = nullptr;
+  if (sqlite3_exec(db, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+    std::string message = error;
+    sqlite3_free(error);
+    throw std::runtime_error("SQLite error: " + message);
+  }
+}
+
+sqlite3_stmt * QuestionStore::prepare(char const * sql) {
+  sqlite3_stmt * statement;
+  if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(std::string("SQLite error: ") + sqlite3_errmsg(db));
+  }
+  return statement;
+}
+
+int QuestionStore::import(std::filesystem::path const & directory) {
+  auto bank = load_question_bank(directory);
+  int imported = 0;
+  std::lock_guard guard(lock);
+  exec("BEGIN");
+  for (auto const & category : bank->categories) {
+    for (auto const & question : category->questions) {
+      sqlite3_bind_text(insert_question, 1, category->name.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_text(insert_question, 2, question.question.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_text(insert_question, 3, question.answer.c_str(), -1, SQLITE_STATIC);
+      sqlite3_bind_int64(insert_question, 4, question.hash);
+      if (sqlite3_step(insert_question) != SQLITE_DONE) {
+        sqlite3_reset(insert_question);
+        exec("ROLLBACK");
+        throw std::runtime_error(std::string("Import failed: ") + sqlite3_errmsg(db));
+      }
+      imported += sqlite3_changes(db);
+      sqlite3_reset(insert_question);
+    }
+  }
+  exec("COMMIT");
+  std::cout << "Imported " << imported << " new questions\n\n";
+  return imported;
+}
+
+StoredQuiz QuestionStore::sample_quiz(
+  int categories, int questions, std::function<bool(Question const &)> const & skip
+) {
+  std::vector<std::shared_ptr<Category>> sampled;
+  std::unique_lock guard(lock);
+
+  sqlite3_bind_int(select_quiz, 1, categories);
+  while (sqlite3_step(select_quiz) == SQLITE_ROW) {
+    auto name = column_text(select_quiz, 0);
+    if (sampled.empty() || sampled.back()->name != name) {
+      sampled.push_back(std::make_shared<Category>());
+      sampled.back()->name = name;
+    }
+    Question question;
+    question.question = column_text(select_quiz, 1);
+    question.answer = column_text(select_quiz, 2);
+    question.hash = sqlite3_column_int64(select_quiz, 3);
+    sampled.back()->questions.push_back(std::move(question));
+  }
+  sqlite3_reset(select_quiz);
+  guard.unlock();
+
+  StoredQuiz quiz;
+  auto bank = std::make_shared<QuestionBank>();
+  for (auto & category : sampled) {
+    Round round { static_cast<uint32_t>(bank->categories.size()),
+      static_cast<uint32_t>(quiz.play_list.questions.size()), 0 };
+    for (uint32_t q = 0; q < category->questions.size() && round.count < questions; q++) {
+      if (skip && skip(category->questions[q])) {
+        continue;
+      }
+      quiz.play_list.questions.push_back(q);
+      round.count += 1;
+    }
+    if (round.count > 0) {
+      quiz.play_list.rounds.push_back(round);
+    }
+    category->answers = std::make_shared<AnswerIndex>(category->questions);
+    bank->categories.push_back(std::move(category));
+  }
+  quiz.bank = std::move(bank);
+  return quiz;
+}
+
+bool QuestionStore::mark_played(Question const & question) {
+  std::lock_guard guard(lock);
+  sqlite3_bind_int64(update_played, 1, std::time(nullptr));
+  sqlite3_bind_int64(update_played, 2, question.hash);
+  bool updated = sqlite3_step(update_played) == SQLITE_DONE && sqlite3_changes(db) == 1;
+  sqlite3_reset(update_played);
+  return updated;
+}
+
+std::vector<StoredMatch> QuestionStore::search(std::string_view query, size_t limit) {
+  // Each word quoted, so punctuation can't be read as FTS5 query syntax
+  std::string match;
+  std::string word;
+  for (size_t i = 0; i <= query.size(); i++) {
+    unsigned char c = i < query.size() ? query[i] : ' ';
+    if (std::isalnum(c) || c >= 0x80) {
+      word += c;
+    } else if (!word.empty()) {
+      match += (match.empty() ? "\"" : " \"") + word + '"';
+      word.clear();
+    }
+  }
+  std::vector<StoredMatch> matches;
+  if (match.empty()) {
+    return matches;
+  }
+
+  std::lock_guard guard(lock);
+  sqlite3_bind_text(search_text, 1, match.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_int64(search_text, 2, limit);
+  while (sqlite3_step(search_text) == SQLITE_ROW) {
+    StoredMatch found;
+    found.id = sqlite3_column_int64(search_text, 0);
+    found.category = column_text(search_text, 1);
+    found.question.question = column_text(search_text, 2);
+    found.question.answer = column_text(search_text, 3);
+    found.question.hash = sqlite3_column_int64(search_text, 4);
+    matches.push_back(std::move(found));
+  }
+  sqlite3_reset(search_text);
+  return matches;
+}
+
+QuestionStore::~QuestionStore() {
+  sqlite3_finalize(insert_question);
+  sqlite3_finalize(select_quiz);
+  sqlite3_finalize(update_played);
+  sqlite3_finalize(search_text);
+  sqlite3_close(db);
+}
@@ -0,0 +1,67 @@
+#ifndef QUESTION_STORE_H_
+#define QUESTION_STORE_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <filesystem>
+
+#include <sqlite3.h>
+
+#include "sampler.h"
+#include "question_bank.h"
+
+// The categories drawn for one quiz and which of their questions to play
+struct StoredQuiz {
+  BankSnapshot bank;
+  PlayList play_list;
+};
+
+struct StoredMatch {
+  std::string category;
+  int64_t id;
+  Question question;
+};
+
+// Questions kept in SQLite rather than in memory. Each quiz is pulled with one
+// indexed query, least recently played questions first.
+class QuestionStore final {
+  // The prepared statements are shared, so rooms take turns
+  std::mutex lock;
+  sqlite3 * db = nullptr;
+  sqlite3_stmt * insert_question = nullptr;
+  sqlite3_stmt * select_quiz = nullptr;
+  sqlite3_stmt * update_played = nullptr;
+  sqlite3_stmt * search_text = nullptr;
+
+  void exec(char const * sql);
+  sqlite3_stmt * prepare(char const * sql);
+
+  public:
+    QuestionStore(std::filesystem::path const & file);
+
+    QuestionStore(QuestionStore const &) = delete;
+    QuestionStore& operator=(QuestionStore const &) = delete;
+
+    // Imports every category file in one transaction, skipping known questions
+    int import(std::filesystem::path const & directory);
+
+    // The next quiz, in a random category order with each category's least
+    // recently played questions first. Questions `skip` rejects aren't played.
+    StoredQuiz sample_quiz(
+      int categories, int questions,
+      std::function<bool(Question const &)> const & skip = {});
+
+    // False if the play couldn't be recorded
+    bool mark_played(Question const & question);
+
+    // Questions containing every word of the query, best matches first
+    std::vector<StoredMatch> search(std::string_view query, size_t limit);
+
+    ~QuestionStore();
+};
+
+#endif
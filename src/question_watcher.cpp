@@ -0,0 +1,118 @@
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "dedupe.h"
+#include "question_watcher.h"
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)
+#define POLL_TIMEOUT_MS 250
+
+QuestionWatcher::QuestionWatcher(
+  LiveQuestionBank & bank, std::filesystem::path directory, bool dedupe
+) : bank{bank}, directory{std::move(directory)}, dedupe{dedupe} {
+  if ((inotify_fd = inotify_init1(IN_CLOEXEC)) == -1) {
+    throw std::runtime_error("Unable to start inotify!");
+  }
+  if (inotify_add_watch(inotify_fd, this->directory.c_str(), WATCH_EVENTS) == -1) {
+    close(inotify_fd);
+    throw std::runtime_error("Unable to watch " + this->directory.string());
+  }
+  watch_thread = std::thread([this]{ watch(); });
+}
+
+BankFilter QuestionWatcher::filter() const {
+  if (!dedupe) {
+    return {};
+  }
+  return [](QuestionBank const & candidate) {
+    return without_near_duplicates(candidate, find_near_duplicates(candidate));
+  };
+}
+
+void QuestionWatcher::reload(std::filesystem::path const & path) {
+  try {
+    bank.replace_category(load_category(path), filter());
+    std::cout << "Reloaded " << path.filename() << '\n';
+  } catch (std::exception const & e) {
+    // Keep serving the old version until the file is fixed
+    std::cerr << e.what() << '\n';
+  }
+}
+
+// After the event queue overflows there's no telling what changed, so every
+// category is reloaded from the directory
+void QuestionWatcher::rescan() {
+  std::cerr << "Missed changes to " << directory << ", reloading every category\n";
+  std::vector<std::filesystem::path> files;
+  std::error_code error;
+  for (auto const & entry : std::filesystem::directory_iterator(directory, error)) {
+    if (entry.path().extension() == ".json") {
+      files.push_back(entry.path());
+    }
+  }
+  if (error) {
+    std::cerr << "Unable to list " << directory << ": " << error.message() << '\n';
+    return;
+  }
+  std::sort(files.begin(), files.end());
+
+  auto current = bank.snapshot();
+  std::vector<CategoryPtr> categories;
+  for (auto const & file : files) {
+    try {
+      categories.push_back(load_category(file));
+    } catch (std::exception const & e) {
+      std::cerr << e.what() << '\n';
+      auto existing = std::find_if(current->categories.begin(), current->categories.end(),
+        [&](auto const & c) { return c->source == file; });
+      if (existing != current->categories.end()) {
+        categories.push_back(*existing);
+      }
+    }
+  }
+  bank.replace_all(std::move(categories), filter());
+}
+
+void QuestionWatcher::watch() {
+  alignas(inotify_event) char buffer[4096];
+  pollfd watched { inotify_fd, POLLIN, 0 };
+  while (running) {
+    if (poll(&watched, 1, POLL_TIMEOUT_MS) <= 0) {
+      continue;
+    }
+    ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+    for (char * ptr = buffer; length > 0 && ptr < buffer + length; ) {
+      auto const * event = reinterpret_cast<inotify_event const *>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        rescan();
+        continue;
+      }
+      if (event->len == 0) {
+        continue;
+      }
+      auto path = directory / event->name;
+      if (path.extension() != ".json") {
+        continue;
+      }
+      if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+        reload(path);
+      } else {
+        bank.remove_category(path);
+      }
+    }
+  }
+}
+
+QuestionWatcher::~QuestionWatcher() {
+  running = false;
+  if (watch_thread.joinable()) {
+    watch_thread.join();
+  }
+  close(inotify_fd);
+}
@@ -0,0 +1,37 @@
+#ifndef QUESTION_WATCHER_H_
+#define QUESTION_WATCHER_H_
+
+#include <atomic>
+#include <thread>
+#include <filesystem>
+
+#include "question_bank.h"
+
+// Watches a question directory with inotify and re-parses only the category
+// files that change, swapping them into the live bank on a background thread.
+class QuestionWatcher final {
+  LiveQuestionBank & bank;
+  std::filesystem::path directory;
+  // Reloads drop near-duplicates too, like --dedupe did at startup
+  bool dedupe;
+
+  int inotify_fd = -1;
+  std::atomic<bool> running = true;
+  std::thread watch_thread;
+
+  void watch();
+  BankFilter filter() const;
+  void reload(std::filesystem::path const & path);
+  void rescan();
+
+  public:
+    QuestionWatcher(
+      LiveQuestionBank & bank, std::filesystem::path directory, bool dedupe = false);
+
+    QuestionWatcher(QuestionWatcher const &) = delete;
+    QuestionWatcher& operator=(QuestionWatcher const &) = delete;
+
+    ~QuestionWatcher();
+};
+
+#endif
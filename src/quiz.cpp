@@ -1,326 +1,575 @@
+#include <mutex>
 #include <atomic>
+#include <memory>
 #include <thread>
-#include <random>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <optional>
 #include <fstream>
-#include <utility>
 #include <iostream>
 #include <filesystem>
 #include <unordered_map>
+#include <algorithm>
+#include <charconv>
 
-#include <CImg.h>
-#include <boost/algorithm/string.hpp>
+#include <unistd.h>
 
 #include "crow.h"
-#include "v4l2_cimg.h"
-#include "imagehelper.h"
-#include "json_wrapper.h"
-#include "rapidjson/istreamwrapper.h"
+#include "dedupe.h"
+#include "trace.h"
+#include "metrics.h"
+#include "quiz_room.h"
+#include "frame_pacer.h"
+#include "search_index.h"
+#include "static_files.h"
+#include "mjpeg_server.h"
+#include "preview_encoder.h"
+#include "state_broadcast.h"
+#include "question_watcher.h"
+
+// Room n streams to /dev/video<n> unless --sink says otherwise
+#define DEFAULT_SINK "v4l2:/dev/video{room}"
+// Override with --fps
+#define DEFAULT_FPS 24
+// With --keepalive-fps, full rate is kept up for this long after a page changes
+#define DEFAULT_ACTIVE_WINDOW 2.0
+// Room n's MJPEG stream is on PREVIEW_PORT + n
+#define PREVIEW_PORT 5001
+#define SEARCH_LIMIT 50
+#define MAX_SEARCH_LIMIT 200
+// Built with `npm run build` in ./controller
+#define CONTROLLER_BUILD "../controller/build"
+
+Metrics::Histogram frame_interval(
+  "quiz_frame_interval_seconds", "Time between frames sent to the video outputs");
+Metrics::Counter frames("quiz_frames_total", "Frames sent to the video outputs");
+
+std::vector<std::unique_ptr<FrameSink>> make_sinks(
+  std::vector<std::string_view> const & specs, int fps, int room
+) {
+  std::vector<std::unique_ptr<FrameSink>> sinks;
+  for (auto spec : specs) {
+    sinks.push_back(make_sink(spec, WIDTH, HEIGHT, fps, room));
+  }
+  return sinks;
+}
 
-using namespace DueUtil::Images;
+// A quiz with its own video outputs, preview stream and controllers. Requests
+// for a room hold its lock, so each quiz only sees one thread at a time.
+struct Room {
+  std::mutex lock;
+  Quiz quiz;
+  PreviewEncoder preview;
+  MjpegServer preview_stream;
+  StateBroadcast broadcast;
+  // Only touched by the display thread once it's started
+  AdaptiveRate rate;
+  std::atomic<bool> displaying = true;
+  std::thread display_thread;
+
+  Room(
+    int id, std::vector<std::string_view> const & sinks, int fps, SharedAssets & assets,
+    LiveQuestionBank & bank, PlayHistory & history, TieBreak const & tie_break,
+    QuestionStore * store
+  ) : quiz(make_sinks(sinks, fps, id), assets, bank, history, tie_break, store),
+      preview_stream(preview, PREVIEW_PORT + id)
+  {
+    quiz.on_frame([this](CImg<uint8_t> const & canvas){
+      preview.submit(canvas);
+    });
+    quiz.on_render([this](QuizState const & state){
+      broadcast.publish(state);
+    });
+  }
 
-#define VIDEO_OUT "/dev/video0"
+  // Each room paces and sends its own frames, so rooms spread across cores
+  // rather than sharing one frame period
+  void start_display(int fps) {
+    display_thread = std::thread([this, fps]{
+      // If the frame is not refreshed enough skype thinks the "webcam" has died!
+      // By default every frame is sent, with --keepalive-fps a room that hasn't
+      // changed for a while only sends that many.
+      FramePacer pacer(fps);
+      auto last_frame = std::chrono::steady_clock::now();
+      while (displaying) {
+        auto now = std::chrono::steady_clock::now();
+        {
+          std::lock_guard guard(lock);
+          if (rate.due(quiz.frame_generation(), now)) {
+            quiz.display();
+            frames.add();
+            frame_interval.record(now - last_frame);
+            last_frame = now;
+          }
+        }
+        pacer.wait();
+      }
+    });
+  }
 
-// This must match what VIDEO_OUT expects!
-#define WIDTH 640
-#define HEIGHT 480
-#define SAFE_WIDTH (WIDTH * 0.8)
+  ~Room() {
+    displaying = false;
+    if (display_thread.joinable()) {
+      display_thread.join();
+    }
+  }
+};
 
-#define ASSETS_BASE "./assets"
-#define TITLE "Ben's Skype Quiz!"
+// A whole query parameter as a number, unset if it isn't one
+template <typename T>
+std::optional<T> parse_number(std::string_view text) {
+  T value;
+  auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
 
-#define TITLE_SIZE 48
-#define TEXT_SIZE 32
+// The host a request was addressed to without its port, e.g. for redirecting
+// to another port on the same server. crow doesn't expose the socket's local
+// address, so requests without a Host header get this machine's name.
+std::string request_host(std::string_view host) {
+  auto colon = host.rfind(':');
+  // A bracketed IPv6 address has colons of its own
+  auto bracket = host.rfind(']');
+  if (colon != host.npos && (bracket == host.npos || colon > bracket)) {
+    host = host.substr(0, colon);
+  }
+  if (host.empty()) {
+    char name[256] = {};
+    gethostname(name, sizeof(name) - 1);
+    return name;
+  }
+  return std::string(host);
+}
 
-namespace json = SleepyDiscord::json;
+#define ROOM_ROUTE(app, url) CROW_ROUTE(app, "/room/<int>" url)
 
-rapidjson::Document load_json_file(std::string path) {
-  std::ifstream ifs(path);
-  rapidjson::IStreamWrapper isw(ifs);
-  rapidjson::Document d;
-  d.ParseStream(isw);
-  return d;
+// Resident set size, for reporting what each room costs
+long resident_kib() {
+  std::ifstream statm("/proc/self/statm");
+  long pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
 }
 
-struct Question {
-  JSONStructCtor(Question)
-  std::string question;
-  std::string answer;
-
-  JSONStructStart
-    std::make_tuple(
-      json::pair(&Question::question, "Quiz question", json::REQUIRIED_FIELD),
-      json::pair(&Question::answer  , "Answer"       , json::REQUIRIED_FIELD)
-    );
-  JSONStructEnd
-};
+// Walks every page of one seeded quiz without a video device, saving each as
+// <out>/page-NNNN.png and comparing it with the same file in `golden`. Returns
+// non-zero if any page doesn't match its golden image.
+int run_headless(
+  BankSnapshot questions, uint32_t seed,
+  char const * out, char const * golden
+) {
+  using clock = std::chrono::steady_clock;
+
+  cimg::srand(seed);
+  SharedAssets assets;
+  LiveQuestionBank bank(std::move(questions));
+  // Nothing skipped or logged, so a seed always gives the same quiz
+  PlayHistory history("/dev/null");
+  auto tie_break = load_tie_break(ASSETS_BASE "/Tie Break.json");
+  if (out) {
+    std::filesystem::create_directories(out);
+  }
 
-using Categories = std::vector<std::pair<std::string, std::vector<Question>>>;
-
-Categories & load_categories() {
-  static Categories categories;
-  for (auto const & entry : std::filesystem::directory_iterator(ASSETS_BASE "/questions")) {
-    if (entry.path().extension() == ".json") {
-      auto category_json = load_json_file(entry.path());
-      auto category_name = entry.path().stem().string();
-      boost::replace_all(category_name, "\"", "");
-      categories.push_back(std::make_pair(category_name, std::vector<Question>{}));
-      auto& [_, questions] = categories.back();
-      std::cout << "Loading " << category_name << " questions!\n";
-      for (Question question : category_json.GetArray()) {
-        std::cout << '\t' << question.question << '\n';
-        questions.push_back(question);
+  Quiz quiz({}, assets, bank, history, tie_break);
+  quiz.seed(seed);
+  auto start = clock::now();
+  quiz.reset(5, 10);
+  auto rendering = clock::now() - start;
+
+  int pages = 0, mismatched = 0;
+  do {
+    char name[32];
+    std::snprintf(name, sizeof(name), "page-%04d.png", pages);
+    if (out) {
+      quiz.frame().save_png((std::filesystem::path(out) / name).c_str());
+    }
+    if (golden) {
+      auto path = std::filesystem::path(golden) / name;
+      CImg<uint8_t> expected;
+      if (std::filesystem::exists(path)) {
+        expected.load_png(path.c_str());
+      }
+      if (expected != quiz.frame()) {
+        std::cerr << name << " doesn't match " << path << '\n';
+        mismatched += 1;
       }
-      std::cout << '\n';
     }
+    pages += 1;
+
+    start = clock::now();
+    quiz.next_page();
+    rendering += clock::now() - start;
+  } while (quiz.state().state != "title");
+
+  double seconds = std::chrono::duration<double>(rendering).count();
+  std::cout << "Rendered " << pages << " pages in " << seconds << "s ("
+    << pages / seconds << " pages/s)\n";
+  if (golden) {
+    std::cout << mismatched << " of " << pages << " pages differ from " << golden << '\n';
   }
-  return categories;
+  return mismatched > 0;
 }
 
-std::vector<std::string> wrap_text(
-  std::string text, DueFont & font, int font_size, int max_width
-) {
-  std::stringstream words(text), current_line;
-  int current_line_len = 0;
-
-  std::vector<std::string> lines;
-  std::string word;
-
-  bool first_word = true;
-  while(words >> word) {
-    int word_width = text_width(word, font, font_size);
-    if (current_line_len + word_width > max_width) {
-      lines.push_back(current_line.str());
-      current_line.str("");
-      first_word = true;
-      current_line_len = 0;
+int main(int argc, char ** argv) {
+  bool dedupe = false, import = false;
+  char const * store_file = nullptr;
+  ScoringConfig scoring;
+  int room_count = 1;
+  bool headless = false;
+  uint32_t seed = std::random_device()();
+  char const * out_dir = nullptr, * golden_dir = nullptr;
+  std::vector<std::string_view> sinks;
+  int fps = DEFAULT_FPS;
+  std::optional<double> keepalive_fps;
+  double active_window = DEFAULT_ACTIVE_WINDOW;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg == "--dedupe") {
+      dedupe = true;
+    } else if (arg == "--store" && i + 1 < argc) {
+      store_file = argv[++i];
+    } else if (arg == "--import") {
+      import = true;
+    } else if (arg == "--max-edits" && i + 1 < argc) {
+      scoring.max_edits = std::stoi(argv[++i]);
+    } else if (arg == "--max-edit-ratio" && i + 1 < argc) {
+      scoring.max_edit_ratio = std::stod(argv[++i]);
+    } else if (arg == "--trace" && i + 1 < argc) {
+      Trace::start(argv[++i]);
+    } else if (arg == "--headless") {
+      headless = true;
+    } else if (arg == "--seed" && i + 1 < argc) {
+      seed = std::stoul(argv[++i]);
+    } else if (arg == "--out" && i + 1 < argc) {
+      out_dir = argv[++i];
+    } else if (arg == "--golden" && i + 1 < argc) {
+      golden_dir = argv[++i];
+    } else if (arg == "--rooms" && i + 1 < argc) {
+      room_count = std::max(1, std::stoi(argv[++i]));
+    } else if (arg == "--sink" && i + 1 < argc) {
+      sinks.push_back(argv[++i]);
+    } else if (arg == "--fps" && i + 1 < argc) {
+      fps = parse_number<int>(argv[++i]).value_or(0);
+    } else if (arg == "--keepalive-fps" && i + 1 < argc) {
+      keepalive_fps = parse_number<double>(argv[++i]).value_or(NAN);
+    } else if (arg == "--active-window" && i + 1 < argc) {
+      active_window = parse_number<double>(argv[++i]).value_or(NAN);
     }
-
-    auto padding = !first_word ? " " : "";
-    current_line << padding << word;
-    first_word = false;
-    current_line_len += word_width + text_width(padding, font, font_size);
   }
-
-  if (current_line_len > 0) {
-    lines.push_back(current_line.str());
+  // The store draws with SQLite's random() and marks what was played, so a
+  // seed wouldn't give the same quiz twice
+  if (headless && store_file) {
+    std::cerr << "--headless can't be used with --store\n";
+    return 1;
   }
-
-  return lines;
-}
-
-int draw_centred_wrapped_text(
-  CImg<uint8_t>& canvas,
-  std::string text, DueFont& font, int font_size, int max_width,
-  Colour const & colour = DUE_BLACK,
-  int start_y = -1,
-  Colour const & stroke = DUE_WHITE
-) {
-  auto lines = wrap_text(text, font, font_size, max_width);
-  int height = lines.size() * font_size;
-
-  start_y = start_y < 0 ? (canvas.height() - height)/2 : start_y;
-  for (int i = 0; i < lines.size(); i++) {
-    auto const & line = lines[i];
-    int width = text_width(line, font, font_size);
-    draw_text(canvas,
-      (canvas.width() - width)/2,
-      start_y + i * font_size,
-      line, font, font_size, colour, -1, 1, stroke);
+  // Before any sink writes a header with it
+  if (fps <= 0) {
+    std::cerr << "--fps must be positive\n";
+    return 1;
+  }
+  if (keepalive_fps && !(*keepalive_fps > 0 && *keepalive_fps < fps)) {
+    std::cerr << "--keepalive-fps must be above 0 and below --fps\n";
+    return 1;
+  }
+  if (!(active_window > 0)) {
+    std::cerr << "--active-window must be a positive number of seconds\n";
+    return 1;
+  }
+  if (sinks.empty()) {
+    sinks.push_back(DEFAULT_SINK);
+  }
+  if (std::find(sinks.begin(), sinks.end(), "pipe") != sinks.end()) {
+    // Before anything is logged, so only video reaches the pipe
+    take_stdout();
   }
 
-  return start_y + height;
-}
-
-Colour const SKYPE_BLUE       (0,   175, 240);
-Colour const QUESTION_ORANGE  (255, 123, 0  );
-Colour const ANSWER_PINK      (255, 102, 255);
+  // With a store the bank stays empty, questions are queried per quiz
+  std::optional<QuestionStore> store;
+  BankSnapshot questions = std::make_shared<QuestionBank>();
+  if (store_file) {
+    store.emplace(store_file);
+    if (import) {
+      store->import(ASSETS_BASE "/questions");
+    }
+  } else {
+    questions = load_question_bank(ASSETS_BASE "/questions");
+  }
+  if (dedupe) {
+    auto duplicates = find_near_duplicates(*questions);
+    std::cout << "Removing " << duplicates.size() << " near-duplicate questions\n\n";
+    questions = without_near_duplicates(*questions, duplicates);
+  }
+  if (headless) {
+    return run_headless(questions, seed, out_dir, golden_dir);
+  }
 
-class Quiz final {
-  CImg<uint8_t> canvas = CImg<uint8_t>(WIDTH, HEIGHT, 1, 3);
-  v4l2_cimg     v4l2   = v4l2_cimg(VIDEO_OUT, canvas.width(), canvas.height());
-  DueFont       font   = DueFont(ASSETS_BASE "/robo.ttf");
+  LiveQuestionBank bank(questions);
+  std::optional<QuestionWatcher> watcher;
+  if (!store) {
+    watcher.emplace(bank, ASSETS_BASE "/questions", dedupe);
+  }
 
-  Categories & categories = load_categories();
+  PlayHistory history(HISTORY_FILE);
+  history.add(*load_question_bank(ASSETS_BASE "/last-weeks-questions"));
+
+  auto tie_break = load_tie_break(ASSETS_BASE "/Tie Break.json");
+
+  SharedAssets assets;
+  long resident_before = resident_kib();
+  std::vector<std::unique_ptr<Room>> rooms;
+  for (int id = 0; id < room_count; id++) {
+    rooms.push_back(std::make_unique<Room>(
+      id, sinks, fps, assets, bank, history, tie_break, store ? &*store : nullptr));
+    rooms.back()->quiz.configure_scoring(scoring);
+    if (keepalive_fps) {
+      using seconds = std::chrono::duration<double>;
+      rooms.back()->rate = AdaptiveRate(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(seconds(active_window)),
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(seconds(1 / *keepalive_fps)));
+    }
+  }
+  std::cout << "Started " << room_count << " rooms, "
+    << (resident_kib() - resident_before) / room_count << "KiB each\n\n";
 
-  std::atomic<bool> display_ready = true;
+  std::thread controller_thread([&]{
+    crow::SimpleApp controller;
 
-  // Quiz state (FSM)
-  int categories_to_play, questions_per_category;
+    // Runs `action` with the room's quiz locked, 404 if there's no such room
+    auto in_room = [&](int id, auto && action) {
+      if (id < 0 || id >= rooms.size()) {
+        return crow::response(404);
+      }
+      std::lock_guard guard(rooms[id]->lock);
+      return action(*rooms[id]);
+    };
+
+    // Connections pick a room by sending its id
+    std::mutex subscriptions_lock;
+    std::unordered_map<crow::websocket::connection *, int> subscriptions;
+    auto unsubscribe = [&](crow::websocket::connection & connection) {
+      auto subscribed = subscriptions.find(&connection);
+      if (subscribed != subscriptions.end()) {
+        rooms[subscribed->second]->broadcast.remove(connection);
+        subscriptions.erase(subscribed);
+      }
+    };
 
-  enum {
-    QUIZ_TITLE,
-    SHOWING_CATEGORY,
-    SHOWING_QUESTION,
-    SHOWING_ANSWER,
-    ANSWERS_TITLE
-  } current_state {QUIZ_TITLE};
+    CROW_ROUTE(controller, "/ws").websocket()
+      .onmessage([&](crow::websocket::connection & connection, std::string const & data, bool){
+        auto room = parse_number<int>(data);
+        if (!room || *room < 0 || *room >= static_cast<int>(rooms.size())) {
+          return;
+        }
+        int id = *room;
+        std::lock_guard guard(subscriptions_lock);
+        unsubscribe(connection);
+        subscriptions[&connection] = id;
+        rooms[id]->broadcast.add(connection);
+      })
+      .onclose([&](crow::websocket::connection & connection, std::string const &){
+        std::lock_guard guard(subscriptions_lock);
+        unsubscribe(connection);
+      });
+
+    ROOM_ROUTE(controller, "/next")([&](crow::request const & req, int id){
+      return in_room(id, [&](Room & room){
+        char const * page = req.url_params.get("page");
+        if (page) {
+          auto expected = parse_number<uint64_t>(page);
+          if (!expected) {
+            return crow::response(400);
+          }
+          return crow::response(room.quiz.next_page(*expected) ? 200 : 409);
+        }
+        room.quiz.next_page();
+        return crow::response(200);
+      });
+    });
 
-  int current_question = 0, current_category = 0;
+    ROOM_ROUTE(controller,"/reset/<int>/<int>")
+    ([&](crow::request const & req, int id, int categories_to_play, int questions_per_category){
+      return in_room(id, [&](Room & room){
+        char const * weights = req.url_params.get("weights");
+        auto weighting = parse_weighting(weights ? weights : "uniform");
+        if (!weighting || !room.quiz.supports(*weighting)) {
+          return crow::response(400);
+        }
+        room.quiz.reset(categories_to_play, questions_per_category, *weighting);
 
-  void draw_title_page(std::string title) {
-    int width = text_width(title, font, 32);
-    draw_centred_wrapped_text(canvas,
-      title, font, TITLE_SIZE, SAFE_WIDTH, SKYPE_BLUE);
-  }
+        rapidjson::Document chances;
+        chances.SetObject();
+        auto & allocator = chances.GetAllocator();
+        for (auto const & [category, chance] : room.quiz.category_chances()) {
+          chances.AddMember(json::Value(category.c_str(), allocator), chance, allocator);
+        }
+        crow::response response(json::stringify(chances));
+        response.add_header("Content-Type", "application/json");
+        return response;
+      });
+    });
 
-  void draw_question_page() {
-    auto const & [_, questions] = categories[current_category];
+    ROOM_ROUTE(controller, "/mode/<string>")([&](int id, std::string const & mode){
+      return in_room(id, [&](Room & room){
+        if (mode != "open" && mode != "choice") {
+          return crow::response(400);
+        }
+        room.quiz.set_multiple_choice(mode == "choice");
+        return crow::response(200);
+      });
+    });
 
-    std::string const & question = questions[current_question].question;
-    draw_centred_wrapped_text(canvas,
-      question, font, TEXT_SIZE, SAFE_WIDTH, QUESTION_ORANGE);
-  }
+    ROOM_ROUTE(controller, "/tiebreak")([&](int id){
+      return in_room(id, [&](Room & room){
+        room.quiz.start_tie_break();
+        return crow::response(200);
+      });
+    });
 
-  void draw_answer_page() {
-    auto const & [_, questions] = categories[current_category];
-    Question const & question = questions[current_question];
+    ROOM_ROUTE(controller, "/tiebreak/guess/<string>/<double>")
+    ([&](int id, std::string const & team, double guess){
+      return in_room(id, [&](Room & room){
+        return crow::response(room.quiz.guess_tie_break(team, guess) ? 200 : 409);
+      });
+    });
 
-    // Wasted computation but fine for this!
-    int question_size = TEXT_SIZE * 0.7;
-    int height =
-      wrap_text(question.question, font, question_size, SAFE_WIDTH).size() * question_size
-      + wrap_text(question.answer, font, TEXT_SIZE, SAFE_WIDTH).size() * TEXT_SIZE;
+    ROOM_ROUTE(controller, "/answer/<string>/<int>/<int>").methods("POST"_method)
+    ([&](crow::request const & req, int id, std::string const & team, int round, int question){
+      return in_room(id, [&](Room & room){
+        return crow::response(
+          room.quiz.submit_answer(team, round, question, req.body) ? 200 : 404);
+      });
+    });
 
-    int offset = draw_centred_wrapped_text(canvas,
-      question.question, font, question_size, SAFE_WIDTH,
-      QUESTION_ORANGE, (HEIGHT - height)/2);
+    ROOM_ROUTE(controller, "/leaderboard")([&](int id){
+      return in_room(id, [&](Room & room){
+        room.quiz.show_leaderboard();
+        return crow::response(200);
+      });
+    });
 
-    draw_centred_wrapped_text(canvas,
-      question.answer, font, TEXT_SIZE, SAFE_WIDTH, ANSWER_PINK, offset);
-  }
+    ROOM_ROUTE(controller, "/scores")([&](int id){
+      return in_room(id, [&](Room & room){
+        rapidjson::Document scores;
+        scores.SetArray();
+        auto & allocator = scores.GetAllocator();
+        for (auto const & [team, score] : room.quiz.scores().scores()) {
+          json::Value entry(rapidjson::kObjectType);
+          entry.AddMember("team", json::Value(team.c_str(), allocator), allocator);
+          entry.AddMember("score", score, allocator);
+          scores.PushBack(entry, allocator);
+        }
+        crow::response response(json::stringify(scores));
+        response.add_header("Content-Type", "application/json");
+        return response;
+      });
+    });
 
-  public:
-    Quiz() {
-      reset(5, 10);
-      render();
-    }
+    // The preview routes don't need the room lock, the encoder has its own
+    ROOM_ROUTE(controller, "/preview.jpg")([&](int id){
+      if (id < 0 || id >= rooms.size()) {
+        return crow::response(404);
+      }
+      auto frame = rooms[id]->preview.frame();
+      if (!frame.jpeg) {
+        return crow::response(503);
+      }
+      crow::response response(*frame.jpeg);
+      response.add_header("Content-Type", "image/jpeg");
+      response.add_header("Cache-Control", "no-cache");
+      return response;
+    });
 
-    void next_page() {
-      switch (current_state) {
-        case QUIZ_TITLE:
-          current_state = SHOWING_CATEGORY;
-          break;
-        case SHOWING_CATEGORY:
-          current_question = 0;
-          current_state = SHOWING_QUESTION;
-          break;
-        case SHOWING_ANSWER:
-        case SHOWING_QUESTION:
-        {
-          auto& questions = std::get<1>(categories[current_category]);
-          current_question += 1;
-          if (current_question >= questions_per_category
-            || current_question >= questions.size()
-          ) {
-            if (current_state == SHOWING_QUESTION) {
-              current_question = 0;
-              current_state = ANSWERS_TITLE;
-            } else {
-              // Simple hack to remove repeat questions
-              if (current_question < questions.size()) {
-                questions.erase(questions.begin(), questions.begin() + current_question);
-                current_category += 1;
-              } else {
-                categories.erase(categories.begin() + current_category);
-                categories_to_play -= 1;
-              }
-              current_state = SHOWING_CATEGORY;
-              if (current_category >= categories_to_play
-                || current_category >= categories.size()
-              ) {
-                current_state = QUIZ_TITLE;
-                current_category = 0;
-              }
-            }
-          }
-          break;
-        }
-        case ANSWERS_TITLE:
-          current_state = SHOWING_ANSWER;
+    // Each room's stream is served by an MjpegServer on its own port
+    ROOM_ROUTE(controller, "/preview.mjpeg")([&](crow::request const & req, int id){
+      if (id < 0 || id >= rooms.size()) {
+        return crow::response(404);
       }
-      render();
-    }
+      auto host = request_host(req.get_header_value("Host"));
+      crow::response response(302);
+      response.add_header("Location",
+        "http://" + host + ":" + std::to_string(PREVIEW_PORT + id) + "/preview.mjpeg");
+      return response;
+    });
 
-    void reset(int categories_to_play, int questions_per_category) {
-      this->categories_to_play = categories_to_play;
-      this->questions_per_category = questions_per_category;
+    CROW_ROUTE(controller, "/metrics")([&](){
+      crow::response response(Metrics::exposition());
+      response.add_header("Content-Type", "text/plain; version=0.0.4");
+      return response;
+    });
 
-      static std::random_device rand;
-      static std::mt19937 prng(rand());
-      std::shuffle(categories.begin(), categories.end(), prng);
-      for (auto& [_, questions]: categories) {
-        std::shuffle(questions.begin(), questions.end(), prng);
+    CROW_ROUTE(controller, "/search")([&](crow::request const & req){
+      char const * query = req.url_params.get("q");
+      char const * limit = req.url_params.get("limit");
+      if (!query) {
+        return crow::response(400);
       }
 
-      current_state = QUIZ_TITLE;
-      current_category = 0;
-      current_question = 0;
-      render();
-    }
-
-    void render() {
-      display_ready = false;
-      canvas.draw_plasma();
-      canvas.draw_rectangle(0, 0, WIDTH, HEIGHT, DUE_BLACK.c_arr(), 0.9);
-
-      switch (current_state) {
-        case QUIZ_TITLE:
-          draw_title_page(TITLE);
-          break;
-        case SHOWING_CATEGORY: {
-          auto const & [category, _] = categories[current_category];
-          draw_title_page(category);
-          break;
+      int max_results = SEARCH_LIMIT;
+      if (limit) {
+        auto parsed = parse_number<int>(limit);
+        if (!parsed) {
+          return crow::response(400);
         }
-        case SHOWING_QUESTION:
-          draw_question_page();
-          break;
-        case ANSWERS_TITLE:
-          draw_title_page("Answers");
-          break;
-        case SHOWING_ANSWER:
-          draw_answer_page();
-          break;
+        max_results = std::clamp(*parsed, 1, MAX_SEARCH_LIMIT);
       }
 
-      display_ready = true;
-    }
-
-    void display() {
-      while (!display_ready);
-      v4l2.display(canvas);
-    }
-};
-
-int main() {
-  using namespace std::chrono_literals;
-
-  Quiz quiz;
-  std::thread controller_thread([&]{
-    crow::SimpleApp controller;
+      rapidjson::Document results;
+      results.SetArray();
+      auto & allocator = results.GetAllocator();
+      auto add_result = [&](std::string const & category, int64_t index, Question const & question) {
+        json::Value result(rapidjson::kObjectType);
+        result.AddMember("category", json::Value(category.c_str(), allocator), allocator);
+        result.AddMember("index", index, allocator);
+        result.AddMember("question", json::Value(question.question.c_str(), allocator), allocator);
+        result.AddMember("answer", json::Value(question.answer.c_str(), allocator), allocator);
+        results.PushBack(result, allocator);
+      };
+
+      // The bank is empty with a store, its index is the store's row id
+      if (store) {
+        for (auto const & match : store->search(query, max_results)) {
+          add_result(match.category, match.id, match.question);
+        }
+      } else {
+        auto snapshot = bank.snapshot();
+        for (auto [category_index, question_index] : snapshot->index->search(query, max_results)) {
+          auto const & category = *snapshot->categories[category_index];
+          add_result(category.name, question_index, category.questions[question_index]);
+        }
+      }
 
-    CROW_ROUTE(controller, "/next")([&](){
-      quiz.next_page();
-      return crow::response(200);
+      crow::response response(json::stringify(results));
+      response.add_header("Content-Type", "application/json");
+      return response;
     });
 
-    CROW_ROUTE(controller,"/reset/<int>/<int>")
-    ([&](int categories_to_play, int questions_per_category){
-      quiz.reset(categories_to_play, questions_per_category);
-      return crow::response(200);
-    });
+    std::optional<StaticFiles> remote;
+    if (std::filesystem::is_directory(CONTROLLER_BUILD)) {
+      remote.emplace(CONTROLLER_BUILD);
+      CROW_ROUTE(controller, "/")([&](crow::request const & req){
+        return remote->serve(req, "");
+      });
+      CROW_ROUTE(controller, "/<path>")([&](crow::request const & req, std::string const & path){
+        return remote->serve(req, path);
+      });
+    } else {
+      std::cerr << "No controller build at " CONTROLLER_BUILD ", only the API is served\n";
+    }
 
-    controller.port(5000).run();
+    // Rooms render on whichever thread handles their request
+    controller.port(5000).multithreaded().run();
   });
 
-  // This wastes a lot of CPU, but if the frame is not refreshed enough
-  // skype thinks the "webcam" has died!
-  while (true) {
-    quiz.display();
-    std::this_thread::sleep_for(1s/24);
+  for (auto & room : rooms) {
+    room->start_display(fps);
   }
 
   controller_thread.join();
@@ -0,0 +1,521 @@
+#include <ctime>
+#include <sstream>
+#include <iostream>
+#include <numeric>
+#include <algorithm>
+
+#include "quiz_room.h"
+#include "answer_index.h"
+#include "text_layout.h"
+#include "trace.h"
+#include "metrics.h"
+
+static Metrics::Histogram render_time("quiz_render_seconds", "Time rendering a page");
+static Metrics::Histogram background_time(
+  "quiz_background_seconds", "Time filling the canvas with a background");
+
+std::optional<Weighting> parse_weighting(std::string_view name) {
+  if (name == "uniform") return Weighting::UNIFORM;
+  if (name == "size") return Weighting::BY_SIZE;
+  if (name == "fresh") return Weighting::BY_FRESHNESS;
+  if (name == "config") return Weighting::BY_CONFIG;
+  return std::nullopt;
+}
+
+Question const & Quiz::question_at(Round const & round, int question) const {
+  return snapshot->categories[round.category]->questions[
+    play_list.questions[round.first + question]];
+}
+
+void Quiz::draw_title_page(std::string title) {
+  int width = text_width(title, font, 32);
+  draw_centred_wrapped_text(canvas,
+    title, font, TITLE_SIZE, SAFE_WIDTH, SKYPE_BLUE);
+}
+
+Quiz::Choices Quiz::choices_for(Round const & round, int question) const {
+  auto const & category = *snapshot->categories[round.category];
+  uint32_t index = play_list.questions[round.first + question];
+  std::mt19937_64 prng(category.questions[index].hash);
+
+  Choices choices;
+  for (uint32_t distractor : category.answers->distractors(index, 3, prng)) {
+    choices.options.push_back(&category.questions[distractor].answer);
+  }
+  std::uniform_int_distribution<int> position(0, choices.options.size());
+  choices.correct = position(prng);
+  choices.options.insert(
+    choices.options.begin() + choices.correct, &category.questions[index].answer);
+  return choices;
+}
+
+void Quiz::draw_question_page() {
+  std::string const & question =
+    question_at(current_round(), current_question).question;
+  if (!multiple_choice) {
+    draw_centred_wrapped_text(canvas,
+      question, font, TEXT_SIZE, SAFE_WIDTH, QUESTION_ORANGE);
+    return;
+  }
+
+  draw_centred_wrapped_text(canvas,
+    question, font, TEXT_SIZE * 0.8, SAFE_WIDTH, QUESTION_ORANGE, HEIGHT / 10);
+
+  // 2x2 grid of options in the bottom half
+  auto choices = choices_for(current_round(), current_question);
+  int cell_width = SAFE_WIDTH / 2, cell_height = HEIGHT * 0.2;
+  int left = (WIDTH - SAFE_WIDTH) / 2, top = HEIGHT / 2;
+  for (int i = 0; i < choices.options.size(); i++) {
+    int x = left + (i % 2) * cell_width, y = top + (i / 2) * cell_height;
+    canvas.draw_rectangle(x + 4, y + 4, x + cell_width - 4, y + cell_height - 4,
+      SKYPE_BLUE.c_arr(), 0.3);
+    draw_wrapped_text_in_box(canvas,
+      std::string(1, 'A' + i) + ") " + *choices.options[i],
+      font, TEXT_SIZE * 0.7, x + 8, y, cell_width - 16, cell_height, ANSWER_PINK);
+  }
+}
+
+void Quiz::draw_answer_page() {
+  Question question = question_at(current_round(), current_question);
+  if (multiple_choice) {
+    auto choices = choices_for(current_round(), current_question);
+    question.answer = std::string(1, 'A' + choices.correct) + ") " + question.answer;
+  }
+
+  // Wasted computation but fine for this!
+  int question_size = TEXT_SIZE * 0.7;
+  int height =
+    wrap_text(question.question, font, question_size, SAFE_WIDTH).size() * question_size
+    + wrap_text(question.answer, font, TEXT_SIZE, SAFE_WIDTH).size() * TEXT_SIZE;
+
+  int offset = draw_centred_wrapped_text(canvas,
+    question.question, font, question_size, SAFE_WIDTH,
+    QUESTION_ORANGE, (HEIGHT - height)/2);
+
+  draw_centred_wrapped_text(canvas,
+    question.answer, font, TEXT_SIZE, SAFE_WIDTH, ANSWER_PINK, offset);
+}
+
+void Quiz::draw_tie_break_question_page() {
+  auto const & question = tie_break.category->questions[
+    tie_break.questions[tie_break_question]];
+  int offset = draw_centred_wrapped_text(canvas,
+    "Tie Break!", font, TITLE_SIZE, SAFE_WIDTH, SKYPE_BLUE, HEIGHT / 8);
+  draw_centred_wrapped_text(canvas,
+    question.question, font, TEXT_SIZE, SAFE_WIDTH, QUESTION_ORANGE, offset + TEXT_SIZE);
+}
+
+void Quiz::draw_tie_break_answer_page() {
+  auto const & question = tie_break.category->questions[
+    tie_break.questions[tie_break_question]];
+
+  std::string winner = "No guesses!";
+  auto closest = closest_guesses(tie_break_guesses, tie_break.answers[tie_break_question]);
+  if (closest.size() == 1) {
+    std::ostringstream guess;
+    guess << closest[0]->first << " wins with " << closest[0]->second;
+    winner = guess.str();
+  } else if (!closest.empty()) {
+    // Equally close guesses share the win
+    std::ostringstream guess;
+    guess << "Tie between ";
+    for (size_t i = 0; i < closest.size(); i++) {
+      if (i > 0) {
+        guess << (i + 1 == closest.size() ? " and " : ", ");
+      }
+      guess << closest[i]->first << " (" << closest[i]->second << ')';
+    }
+    winner = guess.str();
+  }
+
+  int question_size = TEXT_SIZE * 0.7;
+  int height =
+    wrap_text(question.question, font, question_size, SAFE_WIDTH).size() * question_size
+    + wrap_text(question.answer, font, TEXT_SIZE, SAFE_WIDTH).size() * TEXT_SIZE
+    + wrap_text(winner, font, TEXT_SIZE, SAFE_WIDTH).size() * TEXT_SIZE;
+
+  int offset = draw_centred_wrapped_text(canvas,
+    question.question, font, question_size, SAFE_WIDTH,
+    QUESTION_ORANGE, (HEIGHT - height)/2);
+  offset = draw_centred_wrapped_text(canvas,
+    question.answer, font, TEXT_SIZE, SAFE_WIDTH, ANSWER_PINK, offset);
+  draw_centred_wrapped_text(canvas,
+    winner, font, TEXT_SIZE, SAFE_WIDTH, SKYPE_BLUE, offset);
+}
+
+void Quiz::mark_round_played(Round const & round) {
+  for (uint32_t q = round.first; q < round.first + round.count; q++) {
+    played[round.category].insert(play_list.questions[q]);
+  }
+}
+
+void Quiz::sync_with_bank() {
+  auto latest = bank.snapshot();
+  if (snapshot && latest->generation == snapshot->generation) {
+    return;
+  }
+
+  // Unchanged categories keep their played questions, new ones start fresh
+  std::vector<PlayedSet> synced;
+  synced.reserve(latest->categories.size());
+  for (auto const & category : latest->categories) {
+    auto existing = snapshot
+      ? std::find(snapshot->categories.begin(), snapshot->categories.end(), category)
+      : latest->categories.end();
+    if (snapshot && existing != snapshot->categories.end()) {
+      synced.push_back(std::move(played[existing - snapshot->categories.begin()]));
+    } else {
+      synced.emplace_back(category->questions.size());
+    }
+  }
+  played = std::move(synced);
+  snapshot = std::move(latest);
+}
+
+double Quiz::category_weight(Category const & category, rapidjson::Document const & config) {
+  switch (weighting) {
+    case Weighting::UNIFORM:
+      return 1;
+    case Weighting::BY_SIZE:
+      return category.questions.size();
+    case Weighting::BY_FRESHNESS: {
+      double days = (std::time(nullptr) - history.last_played(category.name)) / (24 * 60 * 60);
+      return std::min<double>(days, FRESH_AFTER_DAYS) + 1;
+    }
+    case Weighting::BY_CONFIG: {
+      if (!config.IsObject()) {
+        return 1;
+      }
+      auto weight = config.FindMember(category.name.c_str());
+      return weight != config.MemberEnd() && weight->value.IsNumber()
+        ? std::max(weight->value.GetDouble(), 0.0) : 1;
+    }
+  }
+  return 1;
+}
+
+void Quiz::build_category_table() {
+  uint64_t history_version =
+    weighting == Weighting::BY_FRESHNESS ? history.version() : 0;
+  if (table_generation == snapshot->generation
+    && table_weighting == weighting && table_history == history_version
+  ) {
+    return;
+  }
+
+  rapidjson::Document config;
+  if (weighting == Weighting::BY_CONFIG) {
+    config = load_json_file(CATEGORY_WEIGHTS_FILE);
+  }
+  category_weights.clear();
+  for (auto const & category : snapshot->categories) {
+    category_weights.push_back(category_weight(*category, config));
+  }
+  category_table = AliasTable(category_weights);
+
+  table_generation = snapshot->generation;
+  table_weighting = weighting;
+  table_history = history_version;
+}
+
+void Quiz::play_from_store() {
+  auto quiz = store->sample_quiz(categories_to_play, questions_per_category,
+    [&](Question const & question) { return history.played(question); });
+  snapshot = std::move(quiz.bank);
+  play_list = std::move(quiz.play_list);
+  played.clear();
+  for (auto const & category : snapshot->categories) {
+    played.emplace_back(category->questions.size());
+  }
+}
+
+void Quiz::new_play_list() {
+  current_state = QUIZ_TITLE;
+  current_category = 0;
+  current_question = 0;
+
+  if (store) {
+    play_from_store();
+    return;
+  }
+
+  sync_with_bank();
+  build_category_table();
+  WeightedOrder category_order(category_table, category_weights);
+  play_list = sample_play_list(
+    played, category_order, categories_to_play, questions_per_category, prng,
+    [&](uint32_t category, uint32_t question) {
+      return history.played(snapshot->categories[category]->questions[question]);
+    });
+}
+
+void Quiz::interrupt(State state) {
+  if (current_state != TIE_BREAK_QUESTION && current_state != TIE_BREAK_ANSWER
+    && current_state != LEADERBOARD
+  ) {
+    resume_state = current_state;
+  }
+  current_state = state;
+  page += 1;
+}
+
+char const * Quiz::state_name() const {
+  switch (current_state) {
+    case QUIZ_TITLE: return "title";
+    case SHOWING_CATEGORY: return "category";
+    case SHOWING_QUESTION: return "question";
+    case ANSWERS_TITLE: return "answers";
+    case SHOWING_ANSWER: return "answer";
+    case TIE_BREAK_QUESTION: return "tiebreak";
+    case TIE_BREAK_ANSWER: return "tiebreak_answer";
+    case LEADERBOARD: return "leaderboard";
+  }
+  return "";
+}
+
+Quiz::Quiz(
+  std::vector<std::unique_ptr<FrameSink>> sinks, SharedAssets & assets,
+  LiveQuestionBank & bank, PlayHistory & history, TieBreak const & tie_break,
+  QuestionStore * store
+) : outputs(std::move(sinks)), font{assets.font},
+    backgrounds{assets.backgrounds}, leaderboard(WIDTH, HEIGHT, assets.text_runs),
+    bank{bank}, history{history}, store{store},
+    tie_break{tie_break}, tie_break_order(tie_break.questions.size())
+{
+  reset(5, 10);
+  render();
+}
+
+void Quiz::next_page() {
+  Trace::Span span("next_page");
+  State previous = current_state;
+  switch (current_state) {
+    case QUIZ_TITLE:
+      if (!play_list.rounds.empty()) {
+        current_state = SHOWING_CATEGORY;
+      }
+      break;
+    case SHOWING_CATEGORY:
+      current_question = 0;
+      current_state = SHOWING_QUESTION;
+      break;
+    case SHOWING_ANSWER:
+    case SHOWING_QUESTION:
+      current_question += 1;
+      if (current_question >= current_round().count) {
+        current_question = 0;
+        if (current_state == SHOWING_QUESTION) {
+          current_state = ANSWERS_TITLE;
+        } else {
+          mark_round_played(current_round());
+          current_category += 1;
+          current_state = SHOWING_CATEGORY;
+          if (current_category >= play_list.rounds.size()) {
+            new_play_list();
+          }
+        }
+      }
+      break;
+    case ANSWERS_TITLE:
+      current_state = SHOWING_ANSWER;
+      break;
+    case TIE_BREAK_QUESTION:
+      current_state = TIE_BREAK_ANSWER;
+      break;
+    case TIE_BREAK_ANSWER:
+    case LEADERBOARD:
+      current_state = resume_state;
+  }
+  page += 1;
+  // Resuming after a tie break or the leaderboard shows the same question again
+  bool new_question = previous == SHOWING_CATEGORY || previous == SHOWING_QUESTION;
+  if (current_state == SHOWING_QUESTION && new_question) {
+    auto const & question = question_at(current_round(), current_question);
+    history.record(question, snapshot->categories[current_round().category]->name);
+    if (store && !store->mark_played(question)) {
+      std::cerr << "Unable to mark \"" << question.question << "\" played\n";
+    }
+  }
+  render();
+}
+
+bool Quiz::next_page(uint64_t expected) {
+  if (expected != page) {
+    return false;
+  }
+  next_page();
+  return true;
+}
+
+QuizState Quiz::state() const {
+  QuizState state;
+  state.page = page;
+  state.state = state_name();
+  bool in_round = current_state >= SHOWING_CATEGORY && current_state <= ANSWERS_TITLE
+    && current_category < play_list.rounds.size();
+  if (in_round) {
+    state.round = current_category;
+    state.category = snapshot->categories[current_round().category]->name;
+    if (current_state == SHOWING_QUESTION || current_state == SHOWING_ANSWER) {
+      state.question = current_question;
+    }
+  }
+  return state;
+}
+
+void Quiz::on_render(std::function<void(QuizState const &)> listener) {
+  rendered = std::move(listener);
+  rendered(state());
+}
+
+void Quiz::on_frame(std::function<void(CImg<uint8_t> const &)> listener) {
+  frame_rendered = std::move(listener);
+  frame_rendered(canvas);
+}
+
+void Quiz::start_tie_break() {
+  if (tie_break.questions.empty()) {
+    return;
+  }
+  do {
+    if (tie_break_order.empty()) {
+      tie_break_order = PartialShuffle(tie_break.questions.size());
+    }
+    tie_break_question = tie_break_order.next(prng);
+  } while (history.played(tie_break.category->questions[
+    tie_break.questions[tie_break_question]]) && !tie_break_order.empty());
+
+  interrupt(TIE_BREAK_QUESTION);
+  tie_break_guesses.clear();
+  history.record(tie_break.category->questions[
+    tie_break.questions[tie_break_question]], tie_break.category->name);
+  render();
+}
+
+void Quiz::seed(uint32_t seed) {
+  prng.seed(seed);
+}
+
+void Quiz::configure_scoring(ScoringConfig config) {
+  scoring = config;
+}
+
+bool Quiz::submit_answer(
+  std::string const & team, int round, int question, std::string const & answer
+) {
+  if (round < 0 || round >= play_list.rounds.size()
+    || question < 0 || question >= play_list.rounds[round].count
+  ) {
+    return false;
+  }
+  auto const & expected = question_at(play_list.rounds[round], question).answer;
+  scoreboard.record(team, round, question, is_correct(expected, answer, scoring));
+  if (current_state == LEADERBOARD) {
+    render();
+  }
+  return true;
+}
+
+void Quiz::show_leaderboard() {
+  interrupt(LEADERBOARD);
+  render();
+}
+
+void Quiz::set_multiple_choice(bool enabled) {
+  multiple_choice = enabled;
+  render();
+}
+
+bool Quiz::guess_tie_break(std::string const & team, double guess) {
+  if (current_state != TIE_BREAK_QUESTION) {
+    return false;
+  }
+  tie_break_guesses[team] = guess;
+  return true;
+}
+
+bool Quiz::supports(Weighting weighting) const {
+  return !store || weighting == Weighting::UNIFORM;
+}
+
+void Quiz::reset(
+  int categories_to_play, int questions_per_category, Weighting weighting
+) {
+  this->categories_to_play = categories_to_play;
+  this->questions_per_category = questions_per_category;
+  this->weighting = weighting;
+  scoreboard.clear();
+  new_play_list();
+  page += 1;
+  render();
+}
+
+std::vector<std::pair<std::string, double>> Quiz::category_chances() const {
+  double total = std::accumulate(category_weights.begin(), category_weights.end(), 0.0);
+  std::vector<std::pair<std::string, double>> chances;
+  for (size_t i = 0; i < category_weights.size(); i++) {
+    chances.emplace_back(snapshot->categories[i]->name,
+      total > 0 ? category_weights[i] / total : 0);
+  }
+  return chances;
+}
+
+void Quiz::render() {
+  Metrics::Timer timer(render_time);
+  Trace::Span span("render");
+  display_ready = false;
+  {
+    Metrics::Timer timer(background_time);
+    Trace::Span span("background");
+    canvas = backgrounds.pick(prng);
+  }
+
+  switch (current_state) {
+    case QUIZ_TITLE:
+      draw_title_page(TITLE);
+      break;
+    case SHOWING_CATEGORY: {
+      draw_title_page(snapshot->categories[current_round().category]->name);
+      break;
+    }
+    case SHOWING_QUESTION:
+      draw_question_page();
+      break;
+    case ANSWERS_TITLE:
+      draw_title_page("Answers");
+      break;
+    case SHOWING_ANSWER:
+      draw_answer_page();
+      break;
+    case TIE_BREAK_QUESTION:
+      draw_tie_break_question_page();
+      break;
+    case TIE_BREAK_ANSWER:
+      draw_tie_break_answer_page();
+      break;
+    case LEADERBOARD:
+      leaderboard.update(scoreboard.scores());
+      leaderboard.draw(canvas);
+      break;
+  }
+
+  rendered_frame += 1;
+  display_ready = true;
+  if (rendered) {
+    rendered(state());
+  }
+  if (frame_rendered) {
+    frame_rendered(canvas);
+  }
+}
+
+void Quiz::display() {
+  Trace::Span span("display");
+  while (!display_ready);
+  if (displayed_frame == rendered_frame) {
+    outputs.resubmit();
+    return;
+  }
+  outputs.submit(canvas);
+  displayed_frame = rendered_frame;
+}
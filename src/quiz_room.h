@@ -0,0 +1,218 @@
+#ifndef QUIZ_ROOM_H_
+#define QUIZ_ROOM_H_
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <functional>
+
+#include <CImg.h>
+
+#include "frame_fanout.h"
+#include "sampler.h"
+#include "scoring.h"
+#include "alias_table.h"
+#include "background_cache.h"
+#include "imagehelper.h"
+#include "leaderboard.h"
+#include "play_history.h"
+#include "tie_break.h"
+#include "text_run_cache.h"
+#include "state_broadcast.h"
+#include "question_bank.h"
+#include "question_store.h"
+
+using namespace DueUtil::Images;
+
+// Sinks at other resolutions get a scaled copy
+#define WIDTH 640
+#define HEIGHT 480
+#define SAFE_WIDTH (WIDTH * 0.8)
+
+#define ASSETS_BASE "./assets"
+#define HISTORY_FILE ASSETS_BASE "/play-history"
+#define CATEGORY_WEIGHTS_FILE ASSETS_BASE "/category-weights.json"
+#define FRESH_AFTER_DAYS 28
+#define TITLE "Ben's Skype Quiz!"
+
+#define TITLE_SIZE 48
+#define TEXT_SIZE 32
+
+enum class Weighting {
+  UNIFORM,
+  BY_SIZE,
+  BY_FRESHNESS, // Categories not played for a while are more likely
+  BY_CONFIG     // {"Category": weight} from CATEGORY_WEIGHTS_FILE
+};
+
+std::optional<Weighting> parse_weighting(std::string_view name);
+
+// What every room draws with. The font and text runs lock internally and the
+// backgrounds are read only, so rooms can render at the same time.
+struct SharedAssets {
+  DueFont         font        = DueFont(ASSETS_BASE "/robo.ttf");
+  TextRunCache    text_runs   = TextRunCache(font);
+  BackgroundCache backgrounds = BackgroundCache(WIDTH, HEIGHT);
+};
+
+class Quiz final {
+  CImg<uint8_t> canvas = CImg<uint8_t>(WIDTH, HEIGHT, 1, 3);
+  // Empty when running headless
+  FrameFanout   outputs;
+  DueFont &     font;
+
+  BackgroundCache const & backgrounds;
+  Leaderboard   leaderboard;
+  std::mt19937  prng = std::mt19937(std::random_device()());
+
+  LiveQuestionBank & bank;
+  PlayHistory & history;
+  // If set questions come from here rather than the bank
+  QuestionStore * store;
+  // The snapshot the current quiz was sampled from, reloads are picked up on reset
+  BankSnapshot snapshot;
+  // Played questions for each category in the snapshot (the bank is never modified)
+  std::vector<PlayedSet> played;
+  PlayList play_list;
+
+  Weighting weighting = Weighting::UNIFORM;
+  std::vector<double> category_weights;
+  AliasTable category_table;
+  // What the table was built from, it's rebuilt if any of these change
+  uint64_t table_generation = UINT64_MAX, table_history = 0;
+  Weighting table_weighting;
+
+  std::atomic<bool> display_ready = true;
+  // Bumped on every render, so unchanged frames aren't converted again
+  uint64_t rendered_frame = 0, displayed_frame = UINT64_MAX;
+
+  // Quiz state (FSM)
+  int categories_to_play, questions_per_category;
+
+  enum State {
+    QUIZ_TITLE,
+    SHOWING_CATEGORY,
+    SHOWING_QUESTION,
+    SHOWING_ANSWER,
+    ANSWERS_TITLE,
+    TIE_BREAK_QUESTION,
+    TIE_BREAK_ANSWER,
+    LEADERBOARD
+  } current_state {QUIZ_TITLE};
+
+  int current_question = 0, current_category = 0;
+
+  bool multiple_choice = false;
+
+  ScoringConfig scoring;
+  Scoreboard scoreboard;
+
+  struct Choices {
+    std::vector<std::string const *> options;
+    int correct;
+  };
+
+  // Tie breaks and the leaderboard interrupt the quiz, which picks up where
+  // it was afterwards
+  TieBreak const & tie_break;
+  PartialShuffle tie_break_order;
+  int tie_break_question = 0;
+  Guesses tie_break_guesses;
+  State resume_state;
+
+  Round const & current_round() const { return play_list.rounds[current_category]; }
+
+  Question const & question_at(Round const & round, int question) const;
+  // Seeded by the question so the question and answer pages agree
+  Choices choices_for(Round const & round, int question) const;
+
+  void draw_title_page(std::string title);
+  void draw_question_page();
+  void draw_answer_page();
+  void draw_tie_break_question_page();
+  void draw_tie_break_answer_page();
+
+  void mark_round_played(Round const & round);
+  void sync_with_bank();
+  double category_weight(Category const & category, rapidjson::Document const & config);
+  void build_category_table();
+  void play_from_store();
+  void new_play_list();
+
+  // Pages the controller can't cause are still counted, they're what it's
+  // told is showing
+  uint64_t page = 0;
+  std::function<void(QuizState const &)> rendered;
+  std::function<void(CImg<uint8_t> const &)> frame_rendered;
+
+  void interrupt(State state);
+  char const * state_name() const;
+
+  public:
+    // Without sinks pages are rendered but not streamed anywhere
+    Quiz(
+      std::vector<std::unique_ptr<FrameSink>> sinks, SharedAssets & assets,
+      LiveQuestionBank & bank, PlayHistory & history, TieBreak const & tie_break,
+      QuestionStore * store = nullptr);
+
+    void next_page();
+
+    // Only advances if `expected` is still the page showing, so a controller
+    // that's behind can't skip a page
+    bool next_page(uint64_t expected);
+
+    QuizState state() const;
+
+    // Called with the new state after every render
+    void on_render(std::function<void(QuizState const &)> listener);
+
+    // Called with the canvas after every render
+    void on_frame(std::function<void(CImg<uint8_t> const &)> listener);
+
+    void start_tie_break();
+
+    // Makes which questions are picked (and page backgrounds) repeatable
+    void seed(uint32_t seed);
+
+    void configure_scoring(ScoringConfig config);
+
+    // Marks a team's answer to a question of the current quiz, false if
+    // there's no such question
+    bool submit_answer(
+      std::string const & team, int round, int question, std::string const & answer
+    );
+
+    void show_leaderboard();
+
+    Scoreboard const & scores() const { return scoreboard; }
+
+    void set_multiple_choice(bool enabled);
+
+    bool guess_tie_break(std::string const & team, double guess);
+
+    // Stored questions can only be drawn uniformly
+    bool supports(Weighting weighting) const;
+
+    void reset(
+      int categories_to_play, int questions_per_category,
+      Weighting weighting = Weighting::UNIFORM
+    );
+
+    // The chance of each category being drawn first in the current quiz
+    std::vector<std::pair<std::string, double>> category_chances() const;
+
+    void render();
+
+    CImg<uint8_t> const & frame() const { return canvas; }
+
+    uint64_t frame_generation() const { return rendered_frame; }
+
+    void display();
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "recording_sink.h"
+
+RecordingSink::RecordingSink(std::string const & file, int width, int height, int fps)
+  : frame_format{PixelFormat::I420, width, height}
+{
+  if ((fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) == -1) {
+    throw std::runtime_error("Unable to open " + file);
+  }
+  if (!(index = std::fopen((file + ".index").c_str(), "w"))) {
+    close(fd);
+    throw std::runtime_error("Unable to open " + file + ".index");
+  }
+  auto header = y4m_header(width, height, fps);
+  if (!write_all(fd, reinterpret_cast<uint8_t const *>(header.data()), header.size())) {
+    report_failure(failed, "recording");
+  }
+  disk_thread = std::thread([this]{ write_to_disk(); });
+}
+
+int64_t RecordingSink::elapsed_us() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+}
+
+void RecordingSink::write(std::vector<uint8_t> const & frame) {
+  if (frame == last_frame) {
+    repeats += 1;
+    return;
+  }
+  {
+    std::lock_guard guard(lock);
+    if (queue.size() >= RECORDING_QUEUE) {
+      // Shows as the previous frame held a little longer, and as
+      // last_frame isn't updated the next tick tries again
+      dropped.add();
+      repeats += 1;
+      return;
+    }
+    queue.push_back({ frame, elapsed_us(), repeats });
+  }
+  queued.notify_one();
+  last_frame = frame;
+  repeats = 0;
+}
+
+void RecordingSink::write_to_disk() {
+  bool first = true;
+  while (true) {
+    Pending pending;
+    {
+      std::unique_lock guard(lock);
+      queued.wait(guard, [&]{ return !running || !queue.empty(); });
+      if (queue.empty()) {
+        return;
+      }
+      pending = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    // After a failed write the file can't be trusted to line up with the
+    // index, so the recording stops at the last frame written in full
+    if (failed) {
+      continue;
+    }
+    static uint8_t const frame_header[] = { 'F', 'R', 'A', 'M', 'E', '\n' };
+    if (!write_all(fd, frame_header, sizeof(frame_header))
+      || !write_all(fd, pending.frame.data(), pending.frame.size())
+    ) {
+      report_failure(failed, "recording");
+      continue;
+    }
+
+    if (!first) {
+      std::fprintf(index, " %u\n", pending.previous_repeats);
+    }
+    std::fprintf(index, "%lld", static_cast<long long>(pending.timestamp));
+    // So a killed quiz still leaves an index up to the last frame
+    std::fflush(index);
+    first = false;
+    recorded.add();
+  }
+}
+
+RecordingSink::~RecordingSink() {
+  {
+    std::lock_guard guard(lock);
+    running = false;
+  }
+  queued.notify_one();
+  // Everything queued is written before the thread exits
+  disk_thread.join();
+  // A failed recording is left as if it was never closed cleanly
+  if (!failed) {
+    if (!last_frame.empty()) {
+      std::fprintf(index, " %u\n", repeats);
+    }
+    std::fprintf(index, "end %lld\n", static_cast<long long>(elapsed_us()));
+  }
+  std::fclose(index);
+  close(fd);
+}
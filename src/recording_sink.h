@@ -0,0 +1,74 @@
+#ifndef RECORDING_SINK_H_
+#define RECORDING_SINK_H_
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <condition_variable>
+
+#include "metrics.h"
+#include "frame_sink.h"
+
+// Max distinct frames waiting for the disk, ~15MB at 640x480
+#define RECORDING_QUEUE 32
+
+// Records a session compactly: only distinct frames go into <file> (Y4M), and
+// <file>.index has a "<microseconds> <repeats>" line for each of them, where
+// repeats is how many more times it was displayed, then "end <microseconds>".
+// quiz_expand turns a recording back into constant frame rate video.
+class RecordingSink final : public FrameSink {
+  using clock = std::chrono::steady_clock;
+
+  struct Pending {
+    std::vector<uint8_t> frame;
+    int64_t timestamp;
+    // Repeats of the frame before this one
+    uint32_t previous_repeats;
+  };
+
+  FrameFormat frame_format;
+  clock::time_point start = clock::now();
+
+  // Only touched by the thread writing to the sink
+  std::vector<uint8_t> last_frame;
+  uint32_t repeats = 0;
+
+  std::mutex lock;
+  std::condition_variable queued;
+  std::deque<Pending> queue;
+  bool running = true;
+
+  // Only touched by the disk thread
+  int fd = -1;
+  FILE * index = nullptr;
+  bool failed = false;
+  std::thread disk_thread;
+
+  static inline Metrics::Counter recorded {
+    "quiz_recording_frames_total", "Distinct frames written to recordings" };
+  static inline Metrics::Counter dropped {
+    "quiz_recording_dropped_frames_total", "Distinct frames dropped as the recording queue was full" };
+
+  int64_t elapsed_us() const;
+  void write_to_disk();
+
+  public:
+    RecordingSink(std::string const & file, int width, int height, int fps);
+
+    RecordingSink(RecordingSink const &) = delete;
+    RecordingSink& operator=(RecordingSink const &) = delete;
+
+    FrameFormat format() const override { return frame_format; }
+
+    // Never blocks on the disk
+    void write(std::vector<uint8_t> const & frame) override;
+
+    ~RecordingSink();
+};
+
+#endif
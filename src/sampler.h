@@ -0,0 +1,169 @@
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#include "alias_table.h"
+
+// Alias samples WeightedOrder tries before picking linearly
+#define MAX_REJECTIONS 8
+
+// A Fisher–Yates shuffle of [0, size) that's only performed as far as it's
+// drawn from. Swaps are kept in a sparse map, so drawing k values costs O(k)
+// time and memory no matter how large size is.
+class PartialShuffle final {
+  uint32_t remaining;
+  std::unordered_map<uint32_t, uint32_t> swapped;
+
+  uint32_t at(uint32_t i) const {
+    auto swap = swapped.find(i);
+    return swap != swapped.end() ? swap->second : i;
+  }
+
+  public:
+    PartialShuffle(uint32_t size = 0) : remaining{size} {}
+
+    bool empty() const { return remaining == 0; }
+
+    template <typename URBG>
+    uint32_t next(URBG & prng) {
+      std::uniform_int_distribution<uint32_t> pick(0, remaining - 1);
+      uint32_t i = pick(prng);
+      uint32_t drawn = at(i);
+      remaining -= 1;
+      swapped[i] = at(remaining);
+      swapped.erase(remaining);
+      return drawn;
+    }
+};
+
+// Draws without replacement in proportion to an alias table's weights,
+// never returning an index with no weight. Draws are O(1) while the undrawn
+// weight is most of the total; once a few samples in a row hit drawn indices
+// it picks linearly from what's left, so skewed weights can't make it spin.
+class WeightedOrder final {
+  AliasTable const & table;
+  std::vector<double> const & weights;
+  std::vector<bool> drawn;
+  uint32_t remaining;
+
+  template <typename URBG>
+  uint32_t next_linear(URBG & prng) {
+    double undrawn = 0;
+    for (uint32_t i = 0; i < weights.size(); i++) {
+      undrawn += drawn[i] ? 0 : weights[i];
+    }
+    std::uniform_real_distribution<double> pick(0, undrawn);
+    double target = pick(prng);
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < weights.size(); i++) {
+      if (drawn[i] || weights[i] <= 0) {
+        continue;
+      }
+      last = i;
+      if (target < weights[i]) {
+        break;
+      }
+      target -= weights[i];
+    }
+    // `last` also covers target landing on the total through rounding
+    return last;
+  }
+
+  public:
+    // `table` must be built from `weights`
+    WeightedOrder(AliasTable const & table, std::vector<double> const & weights)
+      : table{table}, weights{weights}, drawn(weights.size()),
+        remaining(std::count_if(weights.begin(), weights.end(),
+          [](double weight) { return weight > 0; })) {}
+
+    bool empty() const { return remaining == 0; }
+
+    template <typename URBG>
+    uint32_t next(URBG & prng) {
+      uint32_t i = table.sample(prng);
+      for (int rejected = 0; drawn[i]; rejected++) {
+        i = rejected < MAX_REJECTIONS ? table.sample(prng) : next_linear(prng);
+      }
+      drawn[i] = true;
+      remaining -= 1;
+      return i;
+    }
+};
+
+// Which questions of a category have been played, O(1) to check or update
+class PlayedSet final {
+  std::vector<bool> played;
+  uint32_t unplayed;
+
+  public:
+    PlayedSet(uint32_t size = 0) : played(size), unplayed{size} {}
+
+    uint32_t size() const { return played.size(); }
+    uint32_t remaining() const { return unplayed; }
+
+    bool contains(uint32_t question) const { return played[question]; }
+
+    void insert(uint32_t question) {
+      if (!played[question]) {
+        played[question] = true;
+        unplayed -= 1;
+      }
+    }
+};
+
+struct Round {
+  uint32_t category;
+  uint32_t first, count;
+};
+
+// The indices a quiz will walk through, questions for round r are
+// questions[rounds[r].first, rounds[r].first + rounds[r].count)
+struct PlayList {
+  std::vector<Round> rounds;
+  std::vector<uint32_t> questions;
+};
+
+// Draws up to `categories` categories with unplayed questions (in the order
+// given by `category_order`, a PartialShuffle or WeightedOrder) and up to
+// `questions` unplayed questions from each. Only the drawn indices are touched,
+// so this costs O(categories + questions) draws while most questions are unplayed.
+// `skip(category, question)` can reject questions played in earlier sessions.
+template <typename Order, typename URBG, typename Skip>
+PlayList sample_play_list(
+  std::vector<PlayedSet> const & played,
+  Order & category_order,
+  int categories, int questions,
+  URBG & prng,
+  Skip skip
+) {
+  PlayList play_list;
+  while (!category_order.empty() && play_list.rounds.size() < categories) {
+    uint32_t category = category_order.next(prng);
+    auto const & category_played = played[category];
+    if (category_played.remaining() == 0) {
+      continue;
+    }
+
+    Round round { category, static_cast<uint32_t>(play_list.questions.size()), 0 };
+    PartialShuffle question_order(category_played.size());
+    while (!question_order.empty() && round.count < questions) {
+      uint32_t question = question_order.next(prng);
+      if (category_played.contains(question) || skip(category, question)) {
+        continue;
+      }
+      play_list.questions.push_back(question);
+      round.count += 1;
+    }
+    if (round.count > 0) {
+      play_list.rounds.push_back(round);
+    }
+  }
+  return play_list;
+}
+
+#endif
@@ -0,0 +1,199 @@
+#include <cctype>
+#include <cstdlib>
+#include <string_view>
+#include <algorithm>
+
+#include "util.h"
+#include "scoring.h"
+#include "answer_index.h"
+
+namespace {
+  // Base letters for U+00C0 to U+00FF
+  char const LATIN_1_FOLDED[] =
+    "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+    "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+  char32_t fold(char32_t c) {
+    if (c >= 0xC0 && c <= 0xFF) {
+      return LATIN_1_FOLDED[c - 0xC0];
+    }
+    if (c < 128) {
+      return std::isalnum(c) ? std::tolower(c) : ' ';
+    }
+    return c;
+  }
+
+  int dp_distance(std::u32string const & a, std::u32string const & b) {
+    std::vector<int> row(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++) row[j] = j;
+    for (size_t i = 1; i <= a.size(); i++) {
+      int diagonal = row[0];
+      row[0] = i;
+      for (size_t j = 1; j <= b.size(); j++) {
+        int above = row[j];
+        row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1]) });
+        diagonal = above;
+      }
+    }
+    return row[b.size()];
+  }
+
+  bool is_digit(std::string_view text, size_t i) {
+    return i < text.size() && std::isdigit(static_cast<unsigned char>(text[i]));
+  }
+
+  // Every number in the text, reading "1,472" and "1 472" as thousands and
+  // "1472.0" as a decimal, so they compare equal to "1472"
+  std::vector<double> numbers_in(std::string_view text) {
+    std::vector<double> numbers;
+    for (size_t i = 0; i < text.size(); ) {
+      if (!is_digit(text, i)) {
+        i++;
+        continue;
+      }
+      bool negative = i > 0 && text[i - 1] == '-'
+        && (i == 1 || !std::isalnum(static_cast<unsigned char>(text[i - 2])));
+      std::string digits = negative ? "-" : "";
+      while (is_digit(text, i)) {
+        digits += text[i++];
+        bool grouped = i < text.size() && (text[i] == ',' || text[i] == ' ')
+          && is_digit(text, i + 1) && is_digit(text, i + 2) && is_digit(text, i + 3)
+          && !is_digit(text, i + 4);
+        if (grouped) {
+          i++;
+        }
+      }
+      if (i + 1 < text.size() && text[i] == '.' && is_digit(text, i + 1)) {
+        digits += text[i++];
+        while (is_digit(text, i)) {
+          digits += text[i++];
+        }
+      }
+      numbers.push_back(std::strtod(digits.c_str(), nullptr));
+    }
+    return numbers;
+  }
+}
+
+std::u32string normalise_answer(std::string const & text) {
+  std::u32string folded;
+  for (char32_t c : DueUtil::Util::to_utf32(text)) {
+    c = fold(c);
+    if (c != ' ' || (!folded.empty() && folded.back() != ' ')) {
+      folded += c;
+    }
+  }
+  if (!folded.empty() && folded.back() == ' ') {
+    folded.pop_back();
+  }
+  for (std::u32string article : { U"the ", U"a ", U"an " }) {
+    if (folded.starts_with(article) && folded.size() > article.size()) {
+      folded.erase(0, article.size());
+      break;
+    }
+  }
+  return folded;
+}
+
+AnswerPattern::AnswerPattern(std::u32string pattern) : pattern{std::move(pattern)} {
+  if (this->pattern.size() > 64) {
+    return;
+  }
+  for (size_t i = 0; i < this->pattern.size(); i++) {
+    char32_t c = this->pattern[i];
+    if (c < 128) {
+      ascii_masks[c] |= 1ull << i;
+      continue;
+    }
+    auto existing = std::find_if(other_masks.begin(), other_masks.end(),
+      [&](auto const & m) { return m.first == c; });
+    if (existing == other_masks.end()) {
+      other_masks.emplace_back(c, 1ull << i);
+    } else {
+      existing->second |= 1ull << i;
+    }
+  }
+}
+
+uint64_t AnswerPattern::mask(char32_t c) const {
+  if (c < 128) {
+    return ascii_masks[c];
+  }
+  for (auto const & [other, mask] : other_masks) {
+    if (other == c) {
+      return mask;
+    }
+  }
+  return 0;
+}
+
+// Myers (1999) as formulated by Hyyrö for global distance: one column of the
+// DP matrix is held as vertical +1/-1 delta bit vectors and updated per text
+// character with a handful of word operations.
+int AnswerPattern::distance(std::u32string const & text) const {
+  size_t m = pattern.size();
+  if (m == 0) {
+    return text.size();
+  }
+  if (m > 64) {
+    return dp_distance(pattern, text);
+  }
+
+  uint64_t pv = ~0ull, mv = 0, last = 1ull << (m - 1);
+  int score = m;
+  for (char32_t c : text) {
+    uint64_t eq = mask(c);
+    uint64_t xv = eq | mv;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    if (ph & last) score += 1;
+    if (mh & last) score -= 1;
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+  }
+  return score;
+}
+
+bool is_correct(
+  std::string const & answer, std::string const & submission, ScoringConfig const & config
+) {
+  auto expected = normalise_answer(answer);
+  auto given = normalise_answer(submission);
+  auto type = answer_type(answer);
+  if (type == AnswerType::YEAR || type == AnswerType::NUMBER) {
+    auto expected_numbers = numbers_in(answer), given_numbers = numbers_in(submission);
+    if (!expected_numbers.empty() && !given_numbers.empty()) {
+      return expected_numbers == given_numbers;
+    }
+    return expected == given;
+  }
+  int allowed = std::max<int>(config.max_edits, config.max_edit_ratio * expected.size());
+  return AnswerPattern(expected).distance(given) <= allowed;
+}
+
+void Scoreboard::record(std::string const & team, int round, int question, bool correct) {
+  std::lock_guard guard(lock);
+  answers[team][{round, question}] = correct;
+}
+
+std::vector<std::pair<std::string, int>> Scoreboard::scores() const {
+  std::lock_guard guard(lock);
+  std::vector<std::pair<std::string, int>> scores;
+  for (auto const & [team, marked] : answers) {
+    int score = std::count_if(marked.begin(), marked.end(),
+      [](auto const & m) { return m.second; });
+    scores.emplace_back(team, score);
+  }
+  std::sort(scores.begin(), scores.end(), [](auto const & a, auto const & b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  return scores;
+}
+
+void Scoreboard::clear() {
+  std::lock_guard guard(lock);
+  answers.clear();
+}
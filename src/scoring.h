@@ -0,0 +1,58 @@
+#ifndef SCORING_H_
+#define SCORING_H_
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <unordered_map>
+
+// Lowercased, accents folded to their base letter, punctuation dropped and
+// leading articles removed, so "The Beatles!" and "beatles" compare equal
+std::u32string normalise_answer(std::string const & text);
+
+// Precomputed match masks for Myers' bit-parallel edit distance
+class AnswerPattern final {
+  std::u32string pattern;
+  std::array<uint64_t, 128> ascii_masks {};
+  std::vector<std::pair<char32_t, uint64_t>> other_masks;
+
+  uint64_t mask(char32_t c) const;
+
+  public:
+    AnswerPattern(std::u32string pattern);
+
+    size_t length() const { return pattern.size(); }
+
+    // Levenshtein distance to `text`, O(|text|) for answers up to 64 characters
+    int distance(std::u32string const & text) const;
+};
+
+struct ScoringConfig {
+  // An answer is right if it's at most max(max_edits, max_edit_ratio * length)
+  // edits away, numeric answers must match exactly
+  int max_edits = 1;
+  double max_edit_ratio = 0.2;
+};
+
+bool is_correct(
+  std::string const & answer, std::string const & submission, ScoringConfig const & config);
+
+// Each team's marked answers, resubmitting replaces the previous answer
+class Scoreboard final {
+  mutable std::mutex lock;
+  std::unordered_map<std::string, std::map<std::pair<int, int>, bool>> answers;
+
+  public:
+    void record(std::string const & team, int round, int question, bool correct);
+
+    // Teams and scores, highest first
+    std::vector<std::pair<std::string, int>> scores() const;
+
+    void clear();
+};
+
+#endif
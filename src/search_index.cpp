@@ -0,0 +1,130 @@
+#include <cctype>
+#include <algorithm>
+
+#include "search_index.h"
+
+namespace {
+  template <typename F>
+  void for_each_word(std::string_view text, F && f) {
+    std::string word;
+    for (unsigned char c : text) {
+      if (std::isalnum(c) || c >= 0x80) {
+        word += std::tolower(c);
+      } else if (!word.empty()) {
+        f(word);
+        word.clear();
+      }
+    }
+    if (!word.empty()) {
+      f(word);
+    }
+  }
+
+  void put_varint(std::vector<uint8_t> & out, uint32_t value) {
+    while (value >= 0x80) {
+      out.push_back(value | 0x80);
+      value >>= 7;
+    }
+    out.push_back(value);
+  }
+
+  uint32_t get_varint(uint8_t const * & ptr) {
+    uint32_t value = 0;
+    for (int shift = 0; ; shift += 7) {
+      uint8_t byte = *ptr++;
+      value |= uint32_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+  }
+}
+
+SearchIndex::SearchIndex(QuestionBank const & bank) {
+  std::unordered_map<std::string, std::vector<uint32_t>> lists;
+  uint32_t id = 0;
+  for (auto const & category : bank.categories) {
+    category_starts.push_back(id);
+    for (auto const & question : category->questions) {
+      auto add = [&](std::string const & word) {
+        auto & list = lists[word];
+        if (list.empty() || list.back() != id) {
+          list.push_back(id);
+        }
+      };
+      for_each_word(question.question, add);
+      for_each_word(question.answer, add);
+      id += 1;
+    }
+  }
+
+  terms.reserve(lists.size());
+  for (auto & [word, list] : lists) {
+    terms[word] = { static_cast<uint32_t>(postings.size()), static_cast<uint32_t>(list.size()) };
+    uint32_t previous = 0;
+    for (uint32_t id : list) {
+      put_varint(postings, id - previous);
+      previous = id;
+    }
+  }
+  postings.shrink_to_fit();
+}
+
+std::vector<uint32_t> SearchIndex::decode(Postings const & term) const {
+  std::vector<uint32_t> ids(term.count);
+  uint8_t const * ptr = postings.data() + term.offset;
+  uint32_t id = 0;
+  for (auto & out : ids) {
+    out = id += get_varint(ptr);
+  }
+  return ids;
+}
+
+QuestionRef SearchIndex::to_ref(uint32_t id) const {
+  auto category = std::upper_bound(category_starts.begin(), category_starts.end(), id) - 1;
+  return { static_cast<uint32_t>(category - category_starts.begin()), id - *category };
+}
+
+std::vector<QuestionRef> SearchIndex::search(std::string_view query, size_t limit) const {
+  std::vector<Postings const *> matched;
+  bool missing = false;
+  for_each_word(query, [&](std::string const & word) {
+    auto term = terms.find(word);
+    if (term == terms.end()) {
+      missing = true;
+    } else {
+      matched.push_back(&term->second);
+    }
+  });
+  if (missing || matched.empty()) {
+    return {};
+  }
+
+  // Intersect starting from the rarest word so the candidate set stays small
+  std::sort(matched.begin(), matched.end(),
+    [](auto const * a, auto const * b) { return a->count < b->count; });
+  auto ids = decode(*matched.front());
+  for (size_t i = 1; i < matched.size() && !ids.empty(); i++) {
+    // Stream the longer list, keeping only the ids it also contains
+    auto const & other = *matched[i];
+    uint8_t const * ptr = postings.data() + other.offset;
+    uint32_t other_id = get_varint(ptr), remaining = other.count - 1;
+    auto kept = ids.begin();
+    for (uint32_t id : ids) {
+      while (other_id < id && remaining > 0) {
+        other_id += get_varint(ptr);
+        remaining -= 1;
+      }
+      if (other_id == id) {
+        *kept++ = id;
+      }
+    }
+    ids.erase(kept, ids.end());
+  }
+
+  std::vector<QuestionRef> results;
+  for (size_t i = 0; i < ids.size() && i < limit; i++) {
+    results.push_back(to_ref(ids[i]));
+  }
+  return results;
+}
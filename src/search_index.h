@@ -0,0 +1,35 @@
+#ifndef SEARCH_INDEX_H_
+#define SEARCH_INDEX_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "question_bank.h"
+
+// Inverted index over question and answer words. Each word's posting list
+// is the sorted question ids it appears in, delta + varint encoded into one
+// shared byte array.
+class SearchIndex final {
+  struct Postings {
+    uint32_t offset, count;
+  };
+
+  std::unordered_map<std::string, Postings> terms;
+  std::vector<uint8_t> postings;
+  // First question id of each category
+  std::vector<uint32_t> category_starts;
+
+  std::vector<uint32_t> decode(Postings const & term) const;
+  QuestionRef to_ref(uint32_t id) const;
+
+  public:
+    SearchIndex(QuestionBank const & bank);
+
+    // Questions containing every word of the query, in bank order
+    std::vector<QuestionRef> search(std::string_view query, size_t limit) const;
+};
+
+#endif
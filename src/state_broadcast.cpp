@@ -0,0 +1,47 @@
+#include "json_wrapper.h"
+#include "state_broadcast.h"
+
+namespace json = SleepyDiscord::json;
+
+static std::string state_json(QuizState const & state, QuizState const * previous) {
+  rapidjson::Document message;
+  message.SetObject();
+  auto & allocator = message.GetAllocator();
+  message.AddMember("page", state.page, allocator);
+  if (!previous || previous->state != state.state) {
+    message.AddMember("state", json::Value(state.state.c_str(), allocator), allocator);
+  }
+  if (!previous || previous->round != state.round) {
+    message.AddMember("round", state.round, allocator);
+  }
+  if (!previous || previous->category != state.category) {
+    message.AddMember("category", json::Value(state.category.c_str(), allocator), allocator);
+  }
+  if (!previous || previous->question != state.question) {
+    message.AddMember("question", state.question, allocator);
+  }
+  return json::stringify(message);
+}
+
+void StateBroadcast::add(crow::websocket::connection & connection) {
+  std::lock_guard guard(lock);
+  connections.insert(&connection);
+  if (last) {
+    connection.send_text(full);
+  }
+}
+
+void StateBroadcast::remove(crow::websocket::connection & connection) {
+  std::lock_guard guard(lock);
+  connections.erase(&connection);
+}
+
+void StateBroadcast::publish(QuizState const & state) {
+  std::lock_guard guard(lock);
+  std::string delta = state_json(state, last ? &*last : nullptr);
+  full = last ? state_json(state, nullptr) : delta;
+  last = state;
+  for (auto connection : connections) {
+    connection->send_text(delta);
+  }
+}
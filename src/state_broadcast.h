@@ -0,0 +1,39 @@
+#ifndef STATE_BROADCAST_H_
+#define STATE_BROADCAST_H_
+
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <unordered_set>
+
+#include "crow.h"
+
+// What the controller needs to know about the page being shown
+struct QuizState {
+  // Counts page changes, so a controller can say which page it's advancing from
+  uint64_t page = 0;
+  std::string state;
+  // -1 when not in a round
+  int round = -1;
+  std::string category;
+  int question = -1;
+};
+
+// Pushes quiz state to every connected controller. Each publish builds one
+// delta of the fields that changed, which is sent to all connections as is.
+class StateBroadcast final {
+  std::mutex lock;
+  std::unordered_set<crow::websocket::connection *> connections;
+  std::optional<QuizState> last;
+  // The last state in full, for controllers that connect later
+  std::string full;
+
+  public:
+    void add(crow::websocket::connection & connection);
+    void remove(crow::websocket::connection & connection);
+
+    void publish(QuizState const & state);
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+#include <zlib.h>
+#include <brotli/encode.h>
+
+#include "static_files.h"
+
+#define GZIP_WINDOW_BITS (15 + 16)
+#define IMMUTABLE_DIRECTORY "static"
+
+static std::string content_type(std::filesystem::path const & path) {
+  static std::unordered_map<std::string, std::string> const types {
+    { ".html", "text/html; charset=utf-8" },
+    { ".js", "application/javascript" },
+    { ".css", "text/css" },
+    { ".json", "application/json" },
+    { ".map", "application/json" },
+    { ".txt", "text/plain; charset=utf-8" },
+    { ".svg", "image/svg+xml" },
+    { ".png", "image/png" },
+    { ".ico", "image/x-icon" },
+    { ".woff2", "font/woff2" },
+  };
+  auto type = types.find(path.extension().string());
+  return type != types.end() ? type->second : "application/octet-stream";
+}
+
+static bool compressible(std::string const & type) {
+  return type.starts_with("text/") || type == "application/javascript"
+    || type == "application/json" || type == "image/svg+xml";
+}
+
+static std::string gzip(std::string const & data) {
+  z_stream stream {};
+  if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, 9,
+      Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("Unable to start gzip!");
+  }
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+  stream.avail_out = compressed.size();
+  int result = deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    throw std::runtime_error("Unable to gzip!");
+  }
+  return compressed;
+}
+
+static std::string brotli(std::string const & data) {
+  size_t size = BrotliEncoderMaxCompressedSize(data.size());
+  std::string compressed(size, '\0');
+  if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+      data.size(), reinterpret_cast<uint8_t const *>(data.data()),
+      &size, reinterpret_cast<uint8_t *>(compressed.data()))) {
+    throw std::runtime_error("Unable to brotli!");
+  }
+  compressed.resize(size);
+  return compressed;
+}
+
+static std::string etag(std::string const & data) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 0x100000001b3;
+  }
+  char tag[17];
+  std::snprintf(tag, sizeof(tag), "%016" PRIx64, hash);
+  return tag;
+}
+
+// If-None-Match is a list of (possibly weak) tags or *, and for it a weak
+// tag matches the strong one
+static bool matches_any(std::string_view header, std::string_view etag) {
+  while (!header.empty()) {
+    auto end = header.find(',');
+    auto entry = header.substr(0, end);
+    header = end == std::string_view::npos ? "" : header.substr(end + 1);
+
+    while (entry.starts_with(' ')) entry.remove_prefix(1);
+    while (entry.ends_with(' ')) entry.remove_suffix(1);
+    if (entry.starts_with("W/")) {
+      entry.remove_prefix(2);
+    }
+    if (entry == "*" || entry == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// True if the client listed `coding` without q=0
+static bool accepts(std::string_view header, std::string_view coding) {
+  while (!header.empty()) {
+    auto end = header.find(',');
+    auto entry = header.substr(0, end);
+    header = end == std::string_view::npos ? "" : header.substr(end + 1);
+
+    auto name_end = entry.find(';');
+    auto name = entry.substr(0, name_end);
+    while (name.starts_with(' ')) name.remove_prefix(1);
+    while (name.ends_with(' ')) name.remove_suffix(1);
+    if (name != coding) {
+      continue;
+    }
+    auto params = name_end == std::string_view::npos ? "" : entry.substr(name_end);
+    auto quality = params.find("q=");
+    return quality == std::string_view::npos
+      || std::strtod(std::string(params.substr(quality + 2)).c_str(), nullptr) > 0;
+  }
+  return false;
+}
+
+StaticFiles::StaticFiles(std::filesystem::path const & root) {
+  size_t total = 0, sent = 0;
+  for (auto const & entry : std::filesystem::recursive_directory_iterator(root)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    std::ifstream in(entry.path(), std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+
+    StaticFile file;
+    file.identity = contents.str();
+    file.content_type = content_type(entry.path());
+    file.etag = etag(file.identity);
+    auto relative = std::filesystem::relative(entry.path(), root);
+    file.immutable = *relative.begin() == IMMUTABLE_DIRECTORY;
+    if (compressible(file.content_type)) {
+      if (auto compressed = gzip(file.identity); compressed.size() < file.identity.size()) {
+        file.gzip = std::move(compressed);
+      }
+      if (auto compressed = brotli(file.identity); compressed.size() < file.identity.size()) {
+        file.brotli = std::move(compressed);
+      }
+    }
+    total += file.identity.size();
+    sent += !file.brotli.empty() ? file.brotli.size() : file.identity.size();
+    files.emplace(relative.generic_string(), std::move(file));
+  }
+  std::cout << "Serving " << files.size() << " controller files, "
+    << total / 1024 << "KiB (" << sent / 1024 << "KiB with brotli)\n";
+}
+
+crow::response StaticFiles::serve(crow::request const & req, std::string path) const {
+  if (path.empty()) {
+    path = "index.html";
+  }
+  auto found = files.find(path);
+  if (found == files.end()) {
+    return crow::response(404);
+  }
+  auto const & file = found->second;
+
+  // Each encoding is its own representation, so has its own strong ETag
+  auto encodings = req.get_header_value("Accept-Encoding");
+  std::string const * body = &file.identity;
+  char const * encoding = nullptr;
+  std::string etag = '"' + file.etag;
+  if (!file.brotli.empty() && accepts(encodings, "br")) {
+    body = &file.brotli;
+    encoding = "br";
+    etag += "-br";
+  } else if (!file.gzip.empty() && accepts(encodings, "gzip")) {
+    body = &file.gzip;
+    encoding = "gzip";
+    etag += "-gz";
+  }
+  etag += '"';
+
+  crow::response response;
+  response.add_header("ETag", etag);
+  response.add_header("Vary", "Accept-Encoding");
+  // Anything not content hashed is revalidated against the ETag
+  response.add_header("Cache-Control", file.immutable
+    ? "public, max-age=31536000, immutable" : "no-cache");
+  if (matches_any(req.get_header_value("If-None-Match"), etag)) {
+    response.code = 304;
+    return response;
+  }
+
+  response.add_header("Content-Type", file.content_type);
+  if (encoding) {
+    response.add_header("Content-Encoding", encoding);
+  }
+  response.body = *body;
+  return response;
+}
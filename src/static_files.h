@@ -0,0 +1,35 @@
+#ifndef STATIC_FILES_H_
+#define STATIC_FILES_H_
+
+#include <string>
+#include <filesystem>
+#include <unordered_map>
+
+#include "crow.h"
+
+struct StaticFile {
+  std::string content_type;
+  // Hash of the content, each encoding's ETag adds its own suffix
+  std::string etag;
+  std::string identity;
+  // Empty when compressing didn't make the file smaller
+  std::string gzip, brotli;
+  // Content hashed file names (CRA's static/) never change
+  bool immutable = false;
+};
+
+// A built web app held in memory, with every compressible file gzipped and
+// brotli'd once at startup
+class StaticFiles final {
+  std::unordered_map<std::string, StaticFile> files;
+
+  public:
+    StaticFiles(std::filesystem::path const & root);
+
+    size_t size() const { return files.size(); }
+
+    // `path` is relative to the root, "" serves index.html
+    crow::response serve(crow::request const & req, std::string path) const;
+};
+
+#endif
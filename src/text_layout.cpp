@@ -0,0 +1,87 @@
+#include <sstream>
+
+#include "trace.h"
+#include "metrics.h"
+#include "imagehelper.h"
+#include "text_layout.h"
+
+using namespace DueUtil::Images;
+
+static Metrics::Histogram layout_time(
+  "quiz_text_layout_seconds", "Time wrapping text into lines");
+
+std::vector<std::string> wrap_text(
+  std::string text, DueFont & font, int font_size, int max_width
+) {
+  Metrics::Timer timer(layout_time);
+  Trace::Span span("wrap_text");
+  std::stringstream words(text), current_line;
+  int current_line_len = 0;
+
+  std::vector<std::string> lines;
+  std::string word;
+
+  bool first_word = true;
+  while(words >> word) {
+    int word_width = text_width(word, font, font_size);
+    if (current_line_len + word_width > max_width) {
+      lines.push_back(current_line.str());
+      current_line.str("");
+      first_word = true;
+      current_line_len = 0;
+    }
+
+    auto padding = !first_word ? " " : "";
+    current_line << padding << word;
+    first_word = false;
+    current_line_len += word_width + text_width(padding, font, font_size);
+  }
+
+  if (current_line_len > 0) {
+    lines.push_back(current_line.str());
+  }
+
+  return lines;
+}
+
+int draw_centred_wrapped_text(
+  CImg<uint8_t>& canvas,
+  std::string text, DueFont& font, int font_size, int max_width,
+  Colour const & colour,
+  int start_y,
+  Colour const & stroke
+) {
+  auto lines = wrap_text(text, font, font_size, max_width);
+  int height = lines.size() * font_size;
+
+  start_y = start_y < 0 ? (canvas.height() - height)/2 : start_y;
+  for (int i = 0; i < lines.size(); i++) {
+    auto const & line = lines[i];
+    int width = text_width(line, font, font_size);
+    draw_text(canvas,
+      (canvas.width() - width)/2,
+      start_y + i * font_size,
+      line, font, font_size, colour, -1, 1, stroke);
+  }
+
+  return start_y + height;
+}
+
+void draw_wrapped_text_in_box(
+  CImg<uint8_t>& canvas,
+  std::string text, DueFont& font, int font_size,
+  int x, int y, int width, int height,
+  Colour const & colour,
+  Colour const & stroke
+) {
+  auto lines = wrap_text(text, font, font_size, width);
+  int start_y = y + (height - int(lines.size()) * font_size)/2;
+  for (int i = 0; i < lines.size(); i++) {
+    auto const & line = lines[i];
+    int line_width = text_width(line, font, font_size);
+    draw_text(canvas,
+      x + (width - line_width)/2,
+      start_y + i * font_size,
+      line, font, font_size, colour, -1, 1, stroke);
+  }
+}
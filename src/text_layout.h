@@ -0,0 +1,33 @@
+#ifndef TEXT_LAYOUT_H_
+#define TEXT_LAYOUT_H_
+
+#include <string>
+#include <vector>
+
+#include <CImg.h>
+
+#include "colour.h"
+#include "fonts/due_font.h"
+
+// Greedy word wrap into lines at most max_width wide
+std::vector<std::string> wrap_text(
+  std::string text, DueUtil::Images::DueFont & font, int font_size, int max_width);
+
+// Draws wrapped lines centred across the canvas, vertically centred if
+// start_y < 0. Returns the y below the last line.
+int draw_centred_wrapped_text(
+  cimg_library::CImg<uint8_t>& canvas,
+  std::string text, DueUtil::Images::DueFont& font, int font_size, int max_width,
+  DueUtil::Images::Colour const & colour = DueUtil::Images::DUE_BLACK,
+  int start_y = -1,
+  DueUtil::Images::Colour const & stroke = DueUtil::Images::DUE_WHITE);
+
+// Draws wrapped lines centred within a box
+void draw_wrapped_text_in_box(
+  cimg_library::CImg<uint8_t>& canvas,
+  std::string text, DueUtil::Images::DueFont& font, int font_size,
+  int x, int y, int width, int height,
+  DueUtil::Images::Colour const & colour = DueUtil::Images::DUE_BLACK,
+  DueUtil::Images::Colour const & stroke = DueUtil::Images::DUE_WHITE);
+
+#endif
@@ -0,0 +1,49 @@
+#include "imagehelper.h"
+#include "text_run_cache.h"
+
+namespace DueUtil::Images {
+  TextRun render_text_run(
+    std::string const & text, DueFont & font, int size,
+    Colour const & colour, int stroke, Colour const & stroke_colour
+  ) {
+    // Glyphs can reach a little above and below the line, pad for them
+    int padding = size / 2 + stroke;
+    int width = text_width(text, font, size);
+    TextRun run {
+      CImg<uint8_t>(width + 2 * padding, size + 2 * padding, 1, 4, 0),
+      padding, padding, width
+    };
+    // Drawing over transparent black leaves colour * coverage in RGB and the
+    // coverage in alpha, a premultiplied image
+    draw_text(run.pixels, padding, padding, text, font, size, colour, -1, stroke, stroke_colour);
+    return run;
+  }
+
+  void draw_text_run(CImg<uint8_t> & canvas, TextRun const & run, int x, int y) {
+    int left = x - run.origin_x, top = y - run.origin_y;
+    cimg_forXY(run.pixels, rx, ry) {
+      int cx = left + rx, cy = top + ry;
+      uint8_t alpha = run.pixels(rx, ry, 3);
+      if (alpha == 0 || cx < 0 || cy < 0 || cx >= canvas.width() || cy >= canvas.height()) {
+        continue;
+      }
+      for (int c = 0; c < canvas.spectrum(); c++) {
+        canvas(cx, cy, c) = run.pixels(rx, ry, c) + canvas(cx, cy, c) * (255 - alpha) / 255;
+      }
+    }
+  }
+
+  TextRun const & TextRunCache::get(
+    std::string const & text, int size, Colour colour,
+    int stroke, Colour const & stroke_colour
+  ) {
+    Key key { text, size, colour.to_int(), stroke, stroke_colour.to_int() };
+    std::lock_guard guard(lock);
+    auto run = runs.find(key);
+    if (run == runs.end()) {
+      run = runs.emplace(key,
+        render_text_run(text, font, size, colour, stroke, stroke_colour)).first;
+    }
+    return run->second;
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef TEXT_RUN_CACHE_H_
+#define TEXT_RUN_CACHE_H_
+
+#include <mutex>
+#include <tuple>
+#include <string>
+#include <unordered_map>
+
+#include <CImg.h>
+
+#include "colour.h"
+#include "fonts/due_font.h"
+
+namespace DueUtil::Images {
+  using namespace cimg_library;
+
+  // A line of text rasterised once into a premultiplied RGBA image
+  struct TextRun {
+    CImg<uint8_t> pixels;
+    // Where the text's draw_text origin is within `pixels`
+    int origin_x, origin_y;
+    int width;
+  };
+
+  TextRun render_text_run(
+    std::string const & text, DueFont & font, int size,
+    Colour const & colour, int stroke = 0, Colour const & stroke_colour = WHITE);
+
+  // Composites a run onto an RGB or premultiplied RGBA canvas as if it was
+  // drawn with draw_text at (x, y)
+  void draw_text_run(CImg<uint8_t> & canvas, TextRun const & run, int x, int y);
+
+  // Rasterised runs keyed on text, size, colour and stroke. Repeated text
+  // (team names, scores) never goes back through FreeType.
+  class TextRunCache final {
+    // Text, size, colour, stroke width, stroke colour
+    using Key = std::tuple<std::string, int, int32_t, int, int32_t>;
+    struct KeyHash {
+      size_t operator()(Key const & key) const {
+        size_t style = std::get<1>(key);
+        style = style * 31 + static_cast<uint32_t>(std::get<2>(key));
+        style = style * 31 + std::get<3>(key);
+        style = style * 31 + static_cast<uint32_t>(std::get<4>(key));
+        return std::hash<std::string>()(std::get<0>(key)) ^ style;
+      }
+    };
+
+    DueFont & font;
+    std::mutex lock;
+    // Runs are never evicted, so references stay valid after unlocking
+    std::unordered_map<Key, TextRun, KeyHash> runs;
+
+    public:
+      TextRunCache(DueFont & font) : font{font} {}
+
+      TextRun const & get(
+        std::string const & text, int size, Colour colour,
+        int stroke = 1, Colour const & stroke_colour = DUE_WHITE);
+
+      size_t size() {
+        std::lock_guard guard(lock);
+        return runs.size();
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <iostream>
+
+#include "tie_break.h"
+
+std::optional<double> parse_number(std::string_view text) {
+  // Pick the longest run of digits (ignoring thousands separators), years
+  // beat days of the month and the like
+  std::optional<double> number;
+  size_t best_digits = 0;
+  for (size_t i = 0; i < text.size(); ) {
+    if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+      i += 1;
+      continue;
+    }
+    std::string digits;
+    size_t digit_count = 0;
+    for (; i < text.size(); i++) {
+      char c = text[i];
+      bool separator = (c == ',' || c == '.') && i + 1 < text.size()
+        && std::isdigit(static_cast<unsigned char>(text[i + 1]));
+      if (std::isdigit(static_cast<unsigned char>(c))) {
+        digits += c;
+        digit_count += 1;
+      } else if (separator) {
+        if (c == '.') digits += c;
+      } else {
+        break;
+      }
+    }
+    if (digit_count > best_digits) {
+      best_digits = digit_count;
+      number = std::stod(digits);
+      if (text.substr(i).starts_with(" BC")) {
+        *number = -*number;
+      }
+    }
+  }
+  return number;
+}
+
+TieBreak load_tie_break(std::filesystem::path const & path) {
+  TieBreak tie_break { load_category(path) };
+  auto const & questions = tie_break.category->questions;
+  for (uint32_t q = 0; q < questions.size(); q++) {
+    if (auto answer = parse_number(questions[q].answer)) {
+      tie_break.questions.push_back(q);
+      tie_break.answers.push_back(*answer);
+    } else {
+      std::cerr << "Skipping tie break without a number: " << questions[q].answer << '\n';
+    }
+  }
+  return tie_break;
+}
+
+std::vector<Guesses::const_iterator> closest_guesses(Guesses const & guesses, double answer) {
+  double closest_distance = INFINITY;
+  for (auto const & [team, guess] : guesses) {
+    closest_distance = std::min(closest_distance, std::abs(guess - answer));
+  }
+  // Allow for rounding, 0.2 and 0.4 are both 0.1 from 0.3
+  double tolerance = 1e-9 * std::max(1.0, std::abs(answer));
+  std::vector<Guesses::const_iterator> closest;
+  for (auto guess = guesses.begin(); guess != guesses.end(); ++guess) {
+    if (std::abs(guess->second - answer) <= closest_distance + tolerance) {
+      closest.push_back(guess);
+    }
+  }
+  std::sort(closest.begin(), closest.end(),
+    [](auto const & a, auto const & b) { return a->first < b->first; });
+  return closest;
+}
@@ -0,0 +1,31 @@
+#ifndef TIE_BREAK_H_
+#define TIE_BREAK_H_
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+#include "question_bank.h"
+
+// The main number in an answer ("1,472", "June 30th 1937", "356 BC")
+std::optional<double> parse_number(std::string_view text);
+
+struct TieBreak {
+  CategoryPtr category;
+  // Parsed at load time, questions without a numeric answer are left out
+  std::vector<uint32_t> questions;
+  std::vector<double> answers;
+};
+
+TieBreak load_tie_break(std::filesystem::path const & path);
+
+using Guesses = std::unordered_map<std::string, double>;
+
+// Every guess equally closest to the answer, ordered by team so a tie always
+// reads the same. Empty if there are no guesses.
+std::vector<Guesses::const_iterator> closest_guesses(Guesses const & guesses, double answer);
+
+#endif
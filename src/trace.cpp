@@ -0,0 +1,140 @@
+#include <mutex>
+#include <cstdio>
+#include <array>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "trace.h"
+
+#define RING_SIZE 16384
+#define DRAIN_INTERVAL std::chrono::milliseconds(100)
+
+namespace Trace {
+  std::atomic<bool> tracing = false;
+
+  namespace {
+    struct Event {
+      char const * name;
+      uint64_t start, end;
+    };
+
+    // Single producer (its thread), single consumer (the writer)
+    struct Ring {
+      std::array<Event, RING_SIZE> events;
+      std::atomic<uint64_t> head = 0, tail = 0;
+      std::atomic<uint64_t> dropped = 0;
+      uint32_t thread;
+    };
+
+    class Writer final {
+      std::mutex lock;
+      std::vector<std::unique_ptr<Ring>> rings;
+      std::ofstream out;
+      uint64_t epoch = 0;
+      bool first_event = true;
+      std::atomic<bool> running = false;
+      std::thread drain_thread;
+
+      // Chrome wants microseconds. Written as fixed point from the integer
+      // nanoseconds, a double would lose precision once sessions get long.
+      void write_microseconds(uint64_t nanoseconds) {
+        char fraction[4];
+        std::snprintf(fraction, sizeof(fraction), "%03u", static_cast<unsigned>(nanoseconds % 1000));
+        out << nanoseconds / 1000 << '.' << fraction;
+      }
+
+      void write_event(Event const & event, uint32_t thread) {
+        out << (first_event ? "\n" : ",\n");
+        first_event = false;
+        out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+            << ",\"ts\":";
+        write_microseconds(event.start > epoch ? event.start - epoch : 0);
+        out << ",\"dur\":";
+        write_microseconds(event.end - event.start);
+        out << '}';
+      }
+
+      void drain() {
+        std::lock_guard guard(lock);
+        for (auto & ring : rings) {
+          uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+          uint64_t head = ring->head.load(std::memory_order_acquire);
+          for (; tail != head; tail++) {
+            write_event(ring->events[tail % RING_SIZE], ring->thread);
+          }
+          ring->tail.store(tail, std::memory_order_release);
+        }
+        out.flush();
+      }
+
+      public:
+        void start(std::filesystem::path const & file) {
+          out.open(file);
+          if (!out) {
+            throw std::runtime_error("Unable to open trace file " + file.string());
+          }
+          // The closing ] is optional in the trace format, so it's valid as it grows
+          out << '[';
+          epoch = now();
+          running = true;
+          drain_thread = std::thread([this]{
+            while (running) {
+              std::this_thread::sleep_for(DRAIN_INTERVAL);
+              drain();
+            }
+          });
+        }
+
+        Ring & register_thread() {
+          std::lock_guard guard(lock);
+          auto & ring = rings.emplace_back(std::make_unique<Ring>());
+          ring->thread = rings.size();
+          return *ring;
+        }
+
+        ~Writer() {
+          if (!running) {
+            return;
+          }
+          tracing = false;
+          running = false;
+          drain_thread.join();
+          drain();
+          uint64_t dropped = 0;
+          for (auto const & ring : rings) {
+            dropped += ring->dropped;
+          }
+          out << "\n]\n";
+          if (dropped) {
+            std::cerr << "Dropped " << dropped << " trace spans\n";
+          }
+        }
+    };
+
+    Writer & writer() {
+      static Writer writer;
+      return writer;
+    }
+  }
+
+  void start(std::filesystem::path const & file) {
+    writer().start(file);
+    tracing = true;
+  }
+
+  void record(char const * name, uint64_t start, uint64_t end) {
+    thread_local Ring & ring = writer().register_thread();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_SIZE) {
+      // The writer has fallen behind, dropping is better than blocking
+      ring.dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring.events[head % RING_SIZE] = { name, start, end };
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+// Scoped spans written out in Chrome's trace event format (loads in Perfetto
+// or chrome://tracing). Each thread records into its own lock-free ring, which
+// a background thread drains to the file, so the file is usable even if the
+// quiz is killed. Spans cost one relaxed load while tracing is off.
+namespace Trace {
+  extern std::atomic<bool> tracing;
+
+  void start(std::filesystem::path const & file);
+
+  inline uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // `name` must outlive the trace, normally it's a string literal
+  void record(char const * name, uint64_t start, uint64_t end);
+
+  class Span final {
+    char const * name;
+    uint64_t start = 0;
+
+    public:
+      Span(char const * name) : name{name} {
+        if (tracing.load(std::memory_order_relaxed)) {
+          start = now();
+        }
+      }
+
+      Span(Span const &) = delete;
+      Span& operator=(Span const &) = delete;
+
+      ~Span() {
+        if (start) {
+          record(name, start, now());
+        }
+      }
+  };
+}
+
+#endif
@@ -14,12 +14,18 @@
 #include <CImg.h>
 #include <formatxx/std_string.h>
 
+#include "trace.h"
+#include "metrics.h"
+#include "frame_sink.h"
+
 using namespace cimg_library;
 
-class v4l2_cimg final {
+class v4l2_cimg final : public FrameSink {
   int fd = -1;
   int width, height;
-  std::vector<uint8_t> frame_buffer;
+
+  static inline Metrics::Histogram write_time {
+    "quiz_v4l2_write_seconds", "Latency of write() to the video device" };
 
   public:
     v4l2_cimg(char const * webcam, int width, int height)
@@ -42,42 +48,19 @@ class v4l2_cimg final {
         throw std::runtime_error(
             formatxx::format_string("Unable to set video format! Errno: {}", errno));
       }
-
-      frame_buffer.resize(vid_format.fmt.pix.sizeimage);
     }
 
-    template <typename T>
-    void display(CImg<T> const & canvas) {
-      if (
-           canvas.width() != width
-        || canvas.height() != height
-        || canvas.spectrum() != 3
-      ) {
-        throw std::runtime_error("Canvas must match v4l2 resolution!");
-      }
+    v4l2_cimg(v4l2_cimg const &) = delete;
+    v4l2_cimg& operator=(v4l2_cimg const &) = delete;
 
-      // Write YUYV frame data
-      bool skip = true;
-      cimg_forXY(canvas, cx, cy) {
-        size_t row = cy * width * 2;
-        T r, g, b;
-        uint8_t y;
-        r = canvas(cx, cy, 0);
-        g = canvas(cx, cy, 1);
-        b = canvas(cx, cy, 2);
+    FrameFormat format() const override {
+      return { PixelFormat::YUYV, width, height };
+    }
 
-        y = std::clamp<uint8_t>(r * .299000 + g * .587000 + b * .114000, 0, 255);
-        frame_buffer[row + cx * 2] = y;
-        if (!skip) {
-          uint8_t u, v;
-          u = std::clamp<uint8_t>(r * -.168736 + g * -.331264 + b * .500000 + 128, 0, 255);
-          v = std::clamp<uint8_t>(r * .500000 + g * -.418688 + b * -.081312 + 128, 0, 255);
-          frame_buffer[row + (cx - 1) * 2 + 1] = u;
-          frame_buffer[row + (cx - 1) * 2 + 3] = v;
-        }
-        skip = !skip;
-      }
-      write(fd, frame_buffer.data(), frame_buffer.size());
+    void write(std::vector<uint8_t> const & frame) override {
+      Trace::Span writing_span("write");
+      Metrics::Timer writing(write_time);
+      ::write(fd, frame.data(), frame.size());
     }
 
     ~v4l2_cimg() {
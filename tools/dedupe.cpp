@@ -0,0 +1,80 @@
+// Reports near-duplicate questions across question directories, and can
+// write out a copy of the bank with the duplicates removed. Each input
+// directory is written to a directory of the same name under out_dir.
+//
+// quiz_dedupe [--threshold 0.5] [--write out_dir] [question_dir...]
+
+#include <set>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+#include "dedupe.h"
+#include "question_bank.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/ostreamwrapper.h"
+
+void write_category(Category const & category, std::filesystem::path const & file) {
+  rapidjson::Document doc;
+  doc.SetArray();
+  for (auto const & question : category.questions) {
+    doc.PushBack(json::toJSON(question, doc.GetAllocator()), doc.GetAllocator());
+  }
+  std::ofstream ofs(file);
+  rapidjson::OStreamWrapper osw(ofs);
+  rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(osw);
+  doc.Accept(writer);
+}
+
+int main(int argc, char ** argv) {
+  float threshold = 0.5f;
+  std::filesystem::path out_dir;
+  std::vector<std::filesystem::path> directories;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--threshold" && i + 1 < argc) {
+      threshold = std::stof(argv[++i]);
+    } else if (arg == "--write" && i + 1 < argc) {
+      out_dir = argv[++i];
+    } else {
+      directories.push_back(arg);
+    }
+  }
+  if (directories.empty()) {
+    directories = { "./assets/questions", "./assets/last-weeks-questions" };
+  }
+
+  QuestionBank bank;
+  for (auto const & directory : directories) {
+    auto loaded = load_question_bank(directory);
+    bank.categories.insert(bank.categories.end(),
+      loaded->categories.begin(), loaded->categories.end());
+  }
+
+  auto duplicates = find_near_duplicates(bank, threshold);
+  for (auto const & [original, duplicate, similarity] : duplicates) {
+    auto const & a = *bank.categories[original.category];
+    auto const & b = *bank.categories[duplicate.category];
+    std::cout << similarity << '\t'
+      << '[' << a.name << "] " << a.questions[original.question].question << "\n\t"
+      << '[' << b.name << "] " << b.questions[duplicate.question].question << '\n';
+  }
+  std::cout << duplicates.size() << " near-duplicates\n";
+
+  if (!out_dir.empty()) {
+    auto filtered = without_near_duplicates(bank, duplicates);
+    // Input directories can share category file names, so each keeps its own
+    // directory under out_dir
+    std::set<std::filesystem::path> written;
+    for (auto const & category : filtered->categories) {
+      auto file = out_dir / category->source.parent_path().filename() / category->source.filename();
+      if (!written.insert(file).second) {
+        std::cerr << "Both " << category->source << " and an earlier category write " << file << '\n';
+        return 1;
+      }
+      std::filesystem::create_directories(file.parent_path());
+      write_category(*category, file);
+    }
+  }
+}
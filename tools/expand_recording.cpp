@@ -0,0 +1,137 @@
+// Expands a recording made with --sink record:<file> into constant frame rate
+// Y4M, each output frame is whichever frame was on screen at that time.
+//
+// quiz_expand [--fps 24] recording.y4m out.y4m
+// quiz_expand recording.y4m - | ffmpeg -i - quiz.mp4
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "frame_sink.h"
+
+struct RecordedFrame {
+  int64_t timestamp;
+  uint32_t repeats;
+};
+
+// Returns the frames and sets `end` to when the recording stopped
+std::vector<RecordedFrame> load_index(std::string const & file, int64_t & end) {
+  std::ifstream index(file);
+  if (!index) {
+    throw std::runtime_error("Unable to open " + file);
+  }
+  std::vector<RecordedFrame> frames;
+  std::string line;
+  end = -1;
+  while (std::getline(index, line)) {
+    std::istringstream fields(line);
+    if (line.rfind("end ", 0) == 0) {
+      fields.ignore(4);
+      fields >> end;
+      continue;
+    }
+    // The last line of an unclosed recording has no repeats yet
+    RecordedFrame frame { 0, 0 };
+    if (fields >> frame.timestamp) {
+      fields >> frame.repeats;
+      frames.push_back(frame);
+    }
+  }
+  if (end < 0) {
+    // Never closed cleanly, stop on the last frame
+    end = frames.empty() ? 0 : frames.back().timestamp;
+  }
+  return frames;
+}
+
+int main(int argc, char ** argv) {
+  int fps = 0;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--fps" && i + 1 < argc) {
+      fps = std::stoi(argv[++i]);
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.size() != 2) {
+    std::cerr << "Usage: quiz_expand [--fps N] recording.y4m out.y4m\n";
+    return 1;
+  }
+
+  int64_t end;
+  auto frames = load_index(files[0] + ".index", end);
+
+  std::ifstream recording(files[0], std::ios::binary);
+  std::string header;
+  if (!std::getline(recording, header) || header.rfind("YUV4MPEG2 ", 0) != 0) {
+    std::cerr << files[0] << " isn't a recording\n";
+    return 1;
+  }
+  int width = 0, height = 0, recorded_fps = 24;
+  std::istringstream params(header);
+  std::string param;
+  while (params >> param) {
+    if (param[0] == 'W') {
+      width = std::stoi(param.substr(1));
+    } else if (param[0] == 'H') {
+      height = std::stoi(param.substr(1));
+    } else if (param[0] == 'F') {
+      recorded_fps = std::stoi(param.substr(1));
+    }
+  }
+  if (fps <= 0) {
+    fps = recorded_fps;
+  }
+
+  FILE * out = files[1] == "-" ? stdout : std::fopen(files[1].c_str(), "wb");
+  if (!out) {
+    std::cerr << "Unable to open " << files[1] << '\n';
+    return 1;
+  }
+  auto out_header = y4m_header(width, height, fps);
+  std::fwrite(out_header.data(), 1, out_header.size(), out);
+
+  size_t frame_size = FrameFormat { PixelFormat::I420, width, height }.size();
+  std::vector<char> frame(frame_size);
+  auto read_frame = [&]{
+    std::string frame_header;
+    return std::getline(recording, frame_header)
+      && recording.read(frame.data(), frame_size);
+  };
+
+  size_t current = 0;
+  if (frames.empty() || !read_frame()) {
+    std::cerr << files[0] << " has no frames\n";
+    return 1;
+  }
+  int64_t written = 0;
+  for (int64_t tick = 0; tick * 1000000 / fps < end; tick++) {
+    int64_t time = tick * 1000000 / fps;
+    while (current + 1 < frames.size() && frames[current + 1].timestamp <= time) {
+      if (!read_frame()) {
+        std::cerr << files[0] << " is shorter than its index\n";
+        return 1;
+      }
+      current += 1;
+    }
+    std::fputs("FRAME\n", out);
+    std::fwrite(frame.data(), 1, frame_size, out);
+    written += 1;
+  }
+  std::fclose(out);
+
+  uint64_t displayed = 0;
+  for (auto const & recorded : frames) {
+    displayed += 1 + recorded.repeats;
+  }
+  std::cerr << "Expanded " << frames.size() << " distinct frames (" << displayed
+    << " displayed) into " << written << " frames at " << fps << " fps\n";
+}